@@ -0,0 +1,61 @@
+#pragma once
+
+#include <crow.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include "services/access_log.hpp"
+#include "services/prisma_client.hpp"
+
+namespace vicrow {
+
+/**
+ * @brief Access logging middleware
+ *
+ * Times each request and hands method, path, status, latency, upstream
+ * time and body size to an AccessLog. Register it first in the middleware
+ * list so requests answered early by other middleware are logged too.
+ */
+struct AccessLogMiddleware {
+    struct context {
+        std::chrono::steady_clock::time_point started;
+    };
+
+    /**
+     * @brief Set the log to write to; logging is off until this is called
+     */
+    void setLog(AccessLog* log) { log_ = log; }
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        ctx.started = std::chrono::steady_clock::now();
+        PrismaClient::resetThreadUpstreamMicros();
+    }
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        if (log_ == nullptr) {
+            return;
+        }
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - ctx.started).count();
+        auto upstream = PrismaClient::threadUpstreamMicros();
+        log_->record(crow::method_name(req.method), req.url, res.code,
+                     static_cast<std::uint32_t>(std::min<std::int64_t>(latency, UINT32_MAX)),
+                     static_cast<std::uint32_t>(std::min<std::uint64_t>(upstream, UINT32_MAX)),
+                     responseBytes(res));
+    }
+
+private:
+    /**
+     * @brief Body size, or the file size for a response served with set_static_file_info
+     */
+    static std::uint64_t responseBytes(crow::response& res) {
+        if (res.is_static_type() && res.file_info.statResult == 0) {
+            return static_cast<std::uint64_t>(res.file_info.statbuf.st_size);
+        }
+        return res.body.size();
+    }
+
+    AccessLog* log_ = nullptr;
+};
+
+} // namespace vicrow
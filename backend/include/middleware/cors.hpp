@@ -16,7 +16,7 @@ struct CORSMiddleware {
             res.code = 204;
             res.add_header("Access-Control-Allow-Origin", "*");
             res.add_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-            res.add_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+            res.add_header("Access-Control-Allow-Headers", "Content-Type, Authorization, X-API-Key");
             res.add_header("Access-Control-Max-Age", "86400");
             res.end();
         }
@@ -25,7 +25,8 @@ struct CORSMiddleware {
     void after_handle(crow::request& req, crow::response& res, context& ctx) {
         res.add_header("Access-Control-Allow-Origin", "*");
         res.add_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-        res.add_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+        res.add_header("Access-Control-Allow-Headers", "Content-Type, Authorization, X-API-Key");
+        res.add_header("Access-Control-Expose-Headers", "Retry-After");
     }
 };
 
@@ -35,7 +36,7 @@ struct CORSMiddleware {
 inline void addCorsHeaders(crow::response& res) {
     res.add_header("Access-Control-Allow-Origin", "*");
     res.add_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-    res.add_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+    res.add_header("Access-Control-Allow-Headers", "Content-Type, Authorization, X-API-Key");
 }
 
 } // namespace vicrow
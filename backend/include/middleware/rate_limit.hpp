@@ -0,0 +1,137 @@
+#pragma once
+
+#include <crow.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace vicrow {
+
+/**
+ * @brief Token bucket budgets and bookkeeping limits for RateLimiter
+ */
+struct RateLimitConfig {
+    bool enabled = true;
+    double readRate = 50.0;        // tokens per second for GET/HEAD
+    double readBurst = 100.0;      // bucket capacity for GET/HEAD
+    double writeRate = 10.0;       // tokens per second for POST/PUT/DELETE
+    double writeBurst = 20.0;      // bucket capacity for POST/PUT/DELETE
+    std::uint32_t idleSeconds = 300;          // reclaim buckets idle this long
+    std::size_t shardCount = 64;
+    std::size_t maxKeysPerShard = 65536;
+    std::unordered_set<std::string> apiKeys;         // keys that get their own budget
+    std::unordered_set<std::string> trustedProxies;  // proxy IPs whose X-Forwarded-For is honoured
+
+    /**
+     * @brief Defaults overridden by VICROW_RATE_LIMIT* environment variables
+     *
+     * Reads VICROW_RATE_LIMIT (`off` disables), VICROW_RATE_LIMIT_READ_RATE,
+     * _READ_BURST, _WRITE_RATE, _WRITE_BURST, VICROW_API_KEYS and
+     * VICROW_TRUSTED_PROXIES (both comma-separated). Invalid values are
+     * reported on stderr and ignored.
+     */
+    static RateLimitConfig fromEnvironment();
+};
+
+/**
+ * @brief Sharded per-client token buckets
+ *
+ * Each client has one bucket per budget (read/write). A bucket is a single
+ * 64-bit atomic packing the refill timestamp and the token count, so taking
+ * a token is a lock-free compare-and-swap. Shard maps are only locked
+ * exclusively to add a new client or reclaim idle ones; lookups share the
+ * lock.
+ */
+class RateLimiter {
+public:
+    explicit RateLimiter(const RateLimitConfig& config = RateLimitConfig());
+
+    /**
+     * @brief Take one token from a client's read or write budget
+     * @param retryAfterMs Set to the wait until a token is available on rejection
+     * @return true if the request may proceed
+     */
+    bool tryAcquire(const std::string& key, bool write, std::uint32_t& retryAfterMs);
+
+    /**
+     * @brief Drop buckets idle for longer than the configured timeout
+     */
+    void sweep();
+
+    std::size_t size() const;
+
+    const RateLimitConfig& config() const { return config_; }
+
+private:
+    struct Budget {
+        std::uint64_t ratePerSec;  // milli-tokens gained per second
+        std::uint64_t capacity;    // milli-tokens
+    };
+
+    struct Bucket {
+        std::atomic<std::uint64_t> read;
+        std::atomic<std::uint64_t> write;
+        std::atomic<std::uint32_t> lastSeen;   // seconds since limiter start
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, std::unique_ptr<Bucket>> buckets;
+    };
+
+    static bool take(std::atomic<std::uint64_t>& state, const Budget& budget,
+                     std::uint64_t nowMs, std::uint32_t& retryAfterMs);
+
+    Shard& shardFor(const std::string& key);
+    void sweepShard(Shard& shard, std::uint32_t nowSec);
+    std::uint64_t nowMs() const;
+
+    RateLimitConfig config_;
+    Budget readBudget_;
+    Budget writeBudget_;
+    std::chrono::steady_clock::time_point epoch_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<std::uint64_t> requests_{0};
+    std::atomic<std::size_t> nextSweep_{0};
+};
+
+/**
+ * @brief Per-client rate limiting middleware
+ *
+ * Clients are keyed by IP. A request carrying an X-API-Key from the
+ * configured allow-list gets that key's budget instead; unknown keys are
+ * ignored, so rotating keys cannot mint fresh buckets. Behind trusted
+ * proxies the IP is the rightmost X-Forwarded-For hop that is not itself a
+ * trusted proxy. Over-budget requests are rejected in before_handle with 429
+ * and a Retry-After header, before any route or upstream work runs.
+ */
+struct RateLimitMiddleware {
+    struct context {};
+
+    RateLimitMiddleware() : limiter_(std::make_shared<RateLimiter>()) {}
+
+    /**
+     * @brief Replace the limits; call before the app starts serving
+     */
+    void configure(const RateLimitConfig& config) {
+        limiter_ = std::make_shared<RateLimiter>(config);
+    }
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {}
+
+private:
+    std::string clientKey(const crow::request& req) const;
+
+    std::shared_ptr<RateLimiter> limiter_;
+};
+
+} // namespace vicrow
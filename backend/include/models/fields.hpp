@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace vicrow {
+
+using json = nlohmann::json;
+
+/**
+ * @brief Helpers for sparse fieldsets
+ *
+ * Every model lists its scalar columns in a FIELD_NAMES array. Bit i of a
+ * field mask selects FIELD_NAMES[i], so the same mask drives both the Prisma
+ * `select` sent upstream and the columns written by to_json().
+ */
+namespace fields {
+
+/**
+ * @brief Mask with every column of a model selected
+ */
+template<std::size_t N>
+constexpr unsigned all(const std::array<const char*, N>&) {
+    return (1u << N) - 1;
+}
+
+/**
+ * @brief Bit for a column name, or 0 if the model has no such column
+ */
+template<std::size_t N>
+unsigned bit(const std::array<const char*, N>& names, const std::string& field) {
+    for (std::size_t i = 0; i < N; ++i) {
+        if (field == names[i]) {
+            return 1u << i;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Build a Prisma `select` object ({"id": true, ...}) from a mask
+ */
+template<std::size_t N>
+json select(const std::array<const char*, N>& names, unsigned mask) {
+    json j = json::object();
+    for (std::size_t i = 0; i < N; ++i) {
+        if (mask & (1u << i)) {
+            j[names[i]] = true;
+        }
+    }
+    return j;
+}
+
+} // namespace fields
+
+} // namespace vicrow
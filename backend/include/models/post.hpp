@@ -0,0 +1,337 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+#include "models/fields.hpp"
+#include "models/user.hpp"
+
+namespace vicrow {
+
+using json = nlohmann::json;
+
+/**
+ * @brief Tag model used to categorize posts
+ */
+struct Tag {
+    enum Field : unsigned {
+        FieldId   = 1u << 0,
+        FieldName = 1u << 1,
+    };
+
+    static constexpr std::array<const char*, 2> FIELD_NAMES{{"id", "name"}};
+    static constexpr unsigned ALL_FIELDS = fields::all(FIELD_NAMES);
+
+    int id = 0;
+    std::string name;
+
+    json to_json(unsigned mask = ALL_FIELDS) const {
+        json j = json::object();
+        if (mask & FieldId) j["id"] = id;
+        if (mask & FieldName) j["name"] = name;
+        return j;
+    }
+
+    static Tag from_json(const json& j) {
+        Tag tag;
+        tag.id = j.value("id", 0);
+        tag.name = j.value("name", "");
+        return tag;
+    }
+};
+
+/**
+ * @brief Comment model representing a comment on a post
+ */
+struct Comment {
+    enum Field : unsigned {
+        FieldId        = 1u << 0,
+        FieldContent   = 1u << 1,
+        FieldCreatedAt = 1u << 2,
+        FieldPostId    = 1u << 3,
+    };
+
+    static constexpr std::array<const char*, 4> FIELD_NAMES{{
+        "id", "content", "createdAt", "postId"
+    }};
+    static constexpr unsigned ALL_FIELDS = fields::all(FIELD_NAMES);
+
+    int id = 0;
+    std::string content;
+    std::string createdAt;
+    int postId = 0;
+
+    json to_json(unsigned mask = ALL_FIELDS) const {
+        json j = json::object();
+        if (mask & FieldId) j["id"] = id;
+        if (mask & FieldContent) j["content"] = content;
+        if (mask & FieldCreatedAt) j["createdAt"] = createdAt;
+        if (mask & FieldPostId) j["postId"] = postId;
+        return j;
+    }
+
+    static Comment from_json(const json& j) {
+        Comment comment;
+        comment.id = j.value("id", 0);
+        comment.content = j.value("content", "");
+        comment.createdAt = j.value("createdAt", "");
+        comment.postId = j.value("postId", 0);
+        return comment;
+    }
+};
+
+/**
+ * @brief Shape of a post read: which columns and relations to fetch
+ *
+ * Built from the `include` and `fields` query parameters, e.g.
+ * `?include=author,tags&fields=id,title,author.name`. A relation mask of 0
+ * means the relation is not included. The whole query is pushed down into a
+ * single Prisma `select`, so relations never cost an extra round trip.
+ */
+struct PostQuery {
+    unsigned postFields = 0;
+    unsigned authorFields = 0;
+    unsigned tagFields = 0;
+    unsigned commentFields = 0;
+
+    /**
+     * @brief Parse `include` and `fields` query parameters (either may be null)
+     * @throws std::invalid_argument on an unknown relation or column
+     */
+    static PostQuery parse(const char* include, const char* fieldList);
+
+    /**
+     * @brief Prisma `select` object for this query
+     */
+    json toSelect() const;
+};
+
+/**
+ * @brief Post model representing blog posts or content
+ */
+struct Post {
+    enum Field : unsigned {
+        FieldId        = 1u << 0,
+        FieldTitle     = 1u << 1,
+        FieldContent   = 1u << 2,
+        FieldPublished = 1u << 3,
+        FieldCreatedAt = 1u << 4,
+        FieldUpdatedAt = 1u << 5,
+        FieldAuthorId  = 1u << 6,
+    };
+
+    static constexpr std::array<const char*, 7> FIELD_NAMES{{
+        "id", "title", "content", "published", "createdAt", "updatedAt", "authorId"
+    }};
+    static constexpr unsigned ALL_FIELDS = fields::all(FIELD_NAMES);
+
+    int id = 0;
+    std::string title;
+    std::optional<std::string> content;
+    bool published = false;
+    std::string createdAt;
+    std::string updatedAt;
+    int authorId = 0;
+    std::optional<User> author;
+    std::vector<Tag> tags;
+    std::vector<Comment> comments;
+
+    /**
+     * @brief Serialize the columns and relations selected by a query
+     */
+    json to_json(const PostQuery& query) const {
+        unsigned mask = query.postFields;
+        json j = json::object();
+        if (mask & FieldId) j["id"] = id;
+        if (mask & FieldTitle) j["title"] = title;
+        if (mask & FieldContent) j["content"] = content.has_value() ? json(content.value()) : json(nullptr);
+        if (mask & FieldPublished) j["published"] = published;
+        if (mask & FieldCreatedAt) j["createdAt"] = createdAt;
+        if (mask & FieldUpdatedAt) j["updatedAt"] = updatedAt;
+        if (mask & FieldAuthorId) j["authorId"] = authorId;
+
+        if (query.authorFields) {
+            j["author"] = author.has_value() ? author->to_json(query.authorFields) : json(nullptr);
+        }
+        if (query.tagFields) {
+            json list = json::array();
+            for (const auto& tag : tags) {
+                list.push_back(tag.to_json(query.tagFields));
+            }
+            j["tags"] = std::move(list);
+        }
+        if (query.commentFields) {
+            json list = json::array();
+            for (const auto& comment : comments) {
+                list.push_back(comment.to_json(query.commentFields));
+            }
+            j["comments"] = std::move(list);
+        }
+        return j;
+    }
+
+    static Post from_json(const json& j) {
+        Post post;
+        post.id = j.value("id", 0);
+        post.title = j.value("title", "");
+        if (j.contains("content") && !j["content"].is_null()) {
+            post.content = j["content"].get<std::string>();
+        }
+        post.published = j.value("published", false);
+        post.createdAt = j.value("createdAt", "");
+        post.updatedAt = j.value("updatedAt", "");
+        post.authorId = j.value("authorId", 0);
+        if (j.contains("author") && j["author"].is_object()) {
+            post.author = User::from_json(j["author"]);
+        }
+        if (j.contains("tags") && j["tags"].is_array()) {
+            for (const auto& item : j["tags"]) {
+                post.tags.push_back(Tag::from_json(item));
+            }
+        }
+        if (j.contains("comments") && j["comments"].is_array()) {
+            for (const auto& item : j["comments"]) {
+                post.comments.push_back(Comment::from_json(item));
+            }
+        }
+        return post;
+    }
+};
+
+/**
+ * @brief DTO for creating a new post
+ */
+struct CreatePostDto {
+    std::string title;
+    std::optional<std::string> content;
+    bool published = false;
+    int authorId = 0;
+    std::vector<std::string> tags;
+
+    static CreatePostDto from_json(const json& j) {
+        CreatePostDto dto;
+        dto.title = j.value("title", "");
+        if (j.contains("content") && !j["content"].is_null()) {
+            dto.content = j["content"].get<std::string>();
+        }
+        dto.published = j.value("published", false);
+        dto.authorId = j.value("authorId", 0);
+        if (j.contains("tags") && j["tags"].is_array()) {
+            for (const auto& tag : j["tags"]) {
+                dto.tags.push_back(tag.get<std::string>());
+            }
+        }
+        return dto;
+    }
+};
+
+/**
+ * @brief DTO for adding a comment to a post
+ */
+struct CreateCommentDto {
+    std::string content;
+
+    static CreateCommentDto from_json(const json& j) {
+        CreateCommentDto dto;
+        dto.content = j.value("content", "");
+        return dto;
+    }
+};
+
+inline PostQuery PostQuery::parse(const char* include, const char* fieldList) {
+    PostQuery query;
+    bool includeAuthor = false;
+    bool includeTags = false;
+    bool includeComments = false;
+
+    auto includeRelation = [&](const std::string& relation) {
+        if (relation == "author") {
+            includeAuthor = true;
+        } else if (relation == "tags") {
+            includeTags = true;
+        } else if (relation == "comments") {
+            includeComments = true;
+        } else {
+            throw std::invalid_argument("Unknown relation '" + relation + "' for posts");
+        }
+    };
+
+    std::string token;
+    if (include != nullptr) {
+        std::istringstream in(include);
+        while (std::getline(in, token, ',')) {
+            if (!token.empty()) {
+                includeRelation(token);
+            }
+        }
+    }
+
+    if (fieldList != nullptr) {
+        std::istringstream in(fieldList);
+        while (std::getline(in, token, ',')) {
+            if (token.empty()) {
+                continue;
+            }
+
+            auto dot = token.find('.');
+            if (dot == std::string::npos) {
+                unsigned bit = fields::bit(Post::FIELD_NAMES, token);
+                if (bit) {
+                    query.postFields |= bit;
+                } else if (token == "author" || token == "tags" || token == "comments") {
+                    // A bare relation name selects the relation with all of its columns
+                    includeRelation(token);
+                } else {
+                    throw std::invalid_argument("Unknown field '" + token + "' for posts");
+                }
+                continue;
+            }
+
+            std::string relation = token.substr(0, dot);
+            std::string column = token.substr(dot + 1);
+            unsigned bit = 0;
+            if (relation == "author") {
+                bit = fields::bit(User::FIELD_NAMES, column);
+                query.authorFields |= bit;
+            } else if (relation == "tags") {
+                bit = fields::bit(Tag::FIELD_NAMES, column);
+                query.tagFields |= bit;
+            } else if (relation == "comments") {
+                bit = fields::bit(Comment::FIELD_NAMES, column);
+                query.commentFields |= bit;
+            } else {
+                throw std::invalid_argument("Unknown relation '" + relation + "' for posts");
+            }
+            if (!bit) {
+                throw std::invalid_argument("Unknown field '" + token + "' for posts");
+            }
+        }
+    }
+
+    // Columns default to "all" unless the client narrowed them down
+    if (!query.postFields) query.postFields = Post::ALL_FIELDS;
+    if (includeAuthor && !query.authorFields) query.authorFields = User::ALL_FIELDS;
+    if (includeTags && !query.tagFields) query.tagFields = Tag::ALL_FIELDS;
+    if (includeComments && !query.commentFields) query.commentFields = Comment::ALL_FIELDS;
+    return query;
+}
+
+inline json PostQuery::toSelect() const {
+    json select = fields::select(Post::FIELD_NAMES, postFields);
+    if (authorFields) {
+        select["author"] = {{"select", fields::select(User::FIELD_NAMES, authorFields)}};
+    }
+    if (tagFields) {
+        select["tags"] = {{"select", fields::select(Tag::FIELD_NAMES, tagFields)}};
+    }
+    if (commentFields) {
+        select["comments"] = {{"select", fields::select(Comment::FIELD_NAMES, commentFields)}};
+    }
+    return select;
+}
+
+} // namespace vicrow
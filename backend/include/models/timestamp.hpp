@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace vicrow {
+
+/**
+ * @brief Fixed-format ISO-8601 timestamps as int64 epoch milliseconds
+ *
+ * Prisma serializes DateTime as `YYYY-MM-DDTHH:MM:SS.mmmZ` (UTC), so both
+ * directions work on fixed offsets instead of going through strptime or
+ * iostreams. Input with a numeric zone offset is converted to UTC. Days are
+ * converted with Howard Hinnant's civil calendar algorithms.
+ */
+namespace timestamp {
+
+namespace detail {
+
+inline bool digits(std::string_view text, std::size_t pos, std::size_t count, int& out) {
+    int value = 0;
+    for (std::size_t i = pos; i < pos + count; ++i) {
+        char c = text[i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+    out = value;
+    return true;
+}
+
+inline std::int64_t daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * static_cast<unsigned>(m + (m > 2 ? -3 : 9)) + 2) / 5 + static_cast<unsigned>(d) - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return static_cast<std::int64_t>(era) * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+inline void civilFromDays(std::int64_t z, int& y, int& m, int& d) {
+    z += 719468;
+    const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    y = static_cast<int>(static_cast<std::int64_t>(yoe) + era * 400 + (m <= 2));
+}
+
+inline void put(char* out, int value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Parse `YYYY-MM-DDTHH:MM:SS[.fff]` followed by `Z` or `±HH:MM` into
+ * epoch milliseconds (UTC)
+ *
+ * Fractions beyond milliseconds are truncated.
+ * @return nullopt if the text is empty or not in that format
+ */
+inline std::optional<std::int64_t> parse(std::string_view text) {
+    int year, month, day, hour, minute, second, millis = 0;
+    if (text.size() < 20
+        || text[4] != '-' || text[7] != '-' || text[10] != 'T'
+        || text[13] != ':' || text[16] != ':'
+        || !detail::digits(text, 0, 4, year) || !detail::digits(text, 5, 2, month)
+        || !detail::digits(text, 8, 2, day) || !detail::digits(text, 11, 2, hour)
+        || !detail::digits(text, 14, 2, minute) || !detail::digits(text, 17, 2, second)) {
+        return std::nullopt;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return std::nullopt;
+    }
+
+    std::size_t pos = 19;
+    if (text[pos] == '.') {
+        std::size_t start = ++pos;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            if (pos - start < 3) {
+                millis = millis * 10 + (text[pos] - '0');
+            }
+            ++pos;
+        }
+        if (pos == start) {
+            return std::nullopt;
+        }
+        for (std::size_t n = pos - start; n < 3; ++n) {
+            millis *= 10;
+        }
+    }
+
+    // A zone designator is required; without one the instant is ambiguous
+    int offsetMinutes = 0;
+    if (pos < text.size() && text[pos] == 'Z') {
+        ++pos;
+    } else if (pos + 6 == text.size() && (text[pos] == '+' || text[pos] == '-') && text[pos + 3] == ':') {
+        int offsetHours, offsetMins;
+        if (!detail::digits(text, pos + 1, 2, offsetHours) || !detail::digits(text, pos + 4, 2, offsetMins)
+            || offsetHours > 23 || offsetMins > 59) {
+            return std::nullopt;
+        }
+        offsetMinutes = (offsetHours * 60 + offsetMins) * (text[pos] == '-' ? -1 : 1);
+        pos += 6;
+    } else {
+        return std::nullopt;
+    }
+    if (pos != text.size()) {
+        return std::nullopt;
+    }
+
+    std::int64_t days = detail::daysFromCivil(year, month, day);
+    return ((days * 24 + hour) * 60 + minute - offsetMinutes) * 60000
+        + static_cast<std::int64_t>(second) * 1000 + millis;
+}
+
+/**
+ * @brief Length of a formatted timestamp, `YYYY-MM-DDTHH:MM:SS.mmmZ`
+ */
+constexpr std::size_t FORMATTED_SIZE = 24;
+
+/**
+ * @brief Write epoch milliseconds as `YYYY-MM-DDTHH:MM:SS.mmmZ` into out[0..24)
+ */
+inline void format(std::int64_t epochMs, char* out) {
+    std::int64_t days = epochMs >= 0 ? epochMs / 86400000 : (epochMs - 86399999) / 86400000;
+    auto msOfDay = static_cast<int>(epochMs - days * 86400000);
+    int year, month, day;
+    detail::civilFromDays(days, year, month, day);
+
+    detail::put(out, year, 4);
+    out[4] = '-';
+    detail::put(out + 5, month, 2);
+    out[7] = '-';
+    detail::put(out + 8, day, 2);
+    out[10] = 'T';
+    detail::put(out + 11, msOfDay / 3600000, 2);
+    out[13] = ':';
+    detail::put(out + 14, msOfDay / 60000 % 60, 2);
+    out[16] = ':';
+    detail::put(out + 17, msOfDay / 1000 % 60, 2);
+    out[19] = '.';
+    detail::put(out + 20, msOfDay % 1000, 3);
+    out[23] = 'Z';
+}
+
+inline std::string format(std::int64_t epochMs) {
+    std::string out(FORMATTED_SIZE, '\0');
+    format(epochMs, &out[0]);
+    return out;
+}
+
+} // namespace timestamp
+
+} // namespace vicrow
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace vicrow {
+
+/**
+ * @brief Percent-encode a URL path segment
+ *
+ * Everything except RFC 3986 unreserved characters is escaped, so the result
+ * is also safe to splice into a shell command line.
+ */
+inline std::string encodePathSegment(std::string_view segment) {
+    static const char* hex = "0123456789ABCDEF";
+    std::string out;
+    out.reserve(segment.size());
+    for (char ch : segment) {
+        auto c = static_cast<unsigned char>(ch);
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')
+            || c == '-' || c == '.' || c == '_' || c == '~') {
+            out += ch;
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 0x0F];
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Decode `%XX` escapes in a URL path segment
+ *
+ * Crow hands route parameters over undecoded. Malformed escapes are kept
+ * as-is; `+` is left alone since it only means space in query strings.
+ */
+inline std::string decodePathSegment(std::string_view segment) {
+    auto hexValue = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+
+    std::string out;
+    out.reserve(segment.size());
+    for (std::size_t i = 0; i < segment.size(); ++i) {
+        if (segment[i] == '%' && i + 2 < segment.size()) {
+            int high = hexValue(segment[i + 1]);
+            int low = hexValue(segment[i + 2]);
+            if (high >= 0 && low >= 0) {
+                out += static_cast<char>(high * 16 + low);
+                i += 2;
+                continue;
+            }
+        }
+        out += segment[i];
+    }
+    return out;
+}
+
+} // namespace vicrow
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 #include <nlohmann/json.hpp>
+#include "models/fields.hpp"
+#include "models/json_string.hpp"
+#include "models/timestamp.hpp"
 
 namespace vicrow {
 
@@ -11,21 +18,48 @@ using json = nlohmann::json;
 
 /**
  * @brief User model representing database user entity
+ *
+ * Timestamps are kept as epoch milliseconds and only formatted as ISO-8601
+ * strings when serialized. A timestamp missing from (or unreadable in) the
+ * upstream row stays empty and is serialized as null.
  */
 struct User {
+    /**
+     * @brief Column bits for sparse fieldsets, in FIELD_NAMES order
+     */
+    enum Field : unsigned {
+        FieldId        = 1u << 0,
+        FieldEmail     = 1u << 1,
+        FieldName      = 1u << 2,
+        FieldCreatedAt = 1u << 3,
+        FieldUpdatedAt = 1u << 4,
+    };
+
+    static constexpr std::array<const char*, 5> FIELD_NAMES{{
+        "id", "email", "name", "createdAt", "updatedAt"
+    }};
+    static constexpr unsigned ALL_FIELDS = fields::all(FIELD_NAMES);
+
     int id;
     std::string email;
     std::optional<std::string> name;
-    std::string createdAt;
-    std::string updatedAt;
+    std::optional<std::int64_t> createdAt;
+    std::optional<std::int64_t> updatedAt;
 
     json to_json() const {
-        json j;
-        j["id"] = id;
-        j["email"] = email;
-        j["name"] = name.has_value() ? json(name.value()) : json(nullptr);
-        j["createdAt"] = createdAt;
-        j["updatedAt"] = updatedAt;
+        return to_json(ALL_FIELDS);
+    }
+
+    /**
+     * @brief Serialize only the columns selected by a field mask
+     */
+    json to_json(unsigned mask) const {
+        json j = json::object();
+        if (mask & FieldId) j["id"] = id;
+        if (mask & FieldEmail) j["email"] = email;
+        if (mask & FieldName) j["name"] = name.has_value() ? json(name.value()) : json(nullptr);
+        if (mask & FieldCreatedAt) j["createdAt"] = timestampJson(createdAt);
+        if (mask & FieldUpdatedAt) j["updatedAt"] = timestampJson(updatedAt);
         return j;
     }
 
@@ -36,12 +70,204 @@ struct User {
         if (j.contains("name") && !j["name"].is_null()) {
             user.name = j["name"].get<std::string>();
         }
-        user.createdAt = j.value("createdAt", "");
-        user.updatedAt = j.value("updatedAt", "");
+        user.createdAt = parseTimestamp(j, "createdAt");
+        user.updatedAt = parseTimestamp(j, "updatedAt");
+        return user;
+    }
+
+    /**
+     * @brief Epoch milliseconds of an ISO-8601 string member, if present and valid
+     */
+    static std::optional<std::int64_t> parseTimestamp(const json& j, const char* key) {
+        auto it = j.find(key);
+        if (it == j.end() || !it->is_string()) {
+            return std::nullopt;
+        }
+        return timestamp::parse(it->get_ref<const std::string&>());
+    }
+
+    static json timestampJson(const std::optional<std::int64_t>& epochMs) {
+        return epochMs.has_value() ? json(timestamp::format(epochMs.value())) : json(nullptr);
+    }
+};
+
+/**
+ * @brief Read-only view of one user stored in a UserList
+ *
+ * Strings point into the list's pool and are valid while the list lives.
+ */
+struct UserView {
+    int id;
+    std::string_view email;
+    std::optional<std::string_view> name;
+    std::optional<std::int64_t> createdAt;
+    std::optional<std::int64_t> updatedAt;
+
+    User toUser() const {
+        User user;
+        user.id = id;
+        user.email = std::string(email);
+        if (name.has_value()) {
+            user.name = std::string(name.value());
+        }
+        user.createdAt = createdAt;
+        user.updatedAt = updatedAt;
         return user;
     }
 };
 
+/**
+ * @brief Compact list of users backed by one contiguous string pool
+ *
+ * Each user is a fixed-size entry (id, epoch-ms timestamps and offsets into
+ * the pool) instead of a User with several heap strings, so large lists and
+ * caches take a fraction of the memory and serialize with sequential reads.
+ */
+class UserList {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = UserView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = UserView;
+
+        const_iterator(const UserList* list, std::size_t index) : list_(list), index_(index) {}
+
+        UserView operator*() const { return (*list_)[index_]; }
+        const_iterator& operator++() { ++index_; return *this; }
+        const_iterator operator++(int) { const_iterator prev = *this; ++index_; return prev; }
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+
+    private:
+        const UserList* list_;
+        std::size_t index_;
+    };
+
+    void reserve(std::size_t count, std::size_t poolBytes) {
+        entries_.reserve(count);
+        pool_.reserve(poolBytes);
+    }
+
+    void push_back(const User& user) {
+        append(user.id, user.email,
+               user.name.has_value() ? std::optional<std::string_view>(user.name.value()) : std::nullopt,
+               user.createdAt, user.updatedAt);
+    }
+
+    /**
+     * @brief Append a user from its parts, copying the strings into the pool
+     */
+    void append(int id, std::string_view email, std::optional<std::string_view> name,
+                std::optional<std::int64_t> createdAt, std::optional<std::int64_t> updatedAt) {
+        Entry entry;
+        entry.id = id;
+        entry.createdAt = createdAt.value_or(NO_TIMESTAMP);
+        entry.updatedAt = updatedAt.value_or(NO_TIMESTAMP);
+        intern(email, entry.emailOffset, entry.emailLength);
+        if (name.has_value()) {
+            intern(name.value(), entry.nameOffset, entry.nameLength);
+        } else {
+            entry.nameOffset = 0;
+            entry.nameLength = NO_NAME;
+        }
+        entries_.push_back(entry);
+    }
+
+    UserView operator[](std::size_t index) const {
+        const Entry& entry = entries_[index];
+        UserView view;
+        view.id = entry.id;
+        view.email = std::string_view(pool_.data() + entry.emailOffset, entry.emailLength);
+        if (entry.nameLength != NO_NAME) {
+            view.name = std::string_view(pool_.data() + entry.nameOffset, entry.nameLength);
+        }
+        if (entry.createdAt != NO_TIMESTAMP) {
+            view.createdAt = entry.createdAt;
+        }
+        if (entry.updatedAt != NO_TIMESTAMP) {
+            view.updatedAt = entry.updatedAt;
+        }
+        return view;
+    }
+
+    std::size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, entries_.size()); }
+
+    /**
+     * @brief Serialize as a JSON array in the shape of the user routes
+     *
+     * Written directly from the pool without building a JSON tree. A null
+     * name is written as "" like the other user routes; a missing timestamp
+     * as null.
+     */
+    std::string dump() const {
+        std::string out;
+        out.reserve(pool_.size() + entries_.size() * 128 + 2);
+        out += '[';
+        char stamp[timestamp::FORMATTED_SIZE];
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            UserView user = (*this)[i];
+            if (i > 0) {
+                out += ',';
+            }
+            out += "{\"id\":";
+            out += std::to_string(user.id);
+            out += ",\"email\":";
+            appendJsonString(out, user.email);
+            out += ",\"name\":";
+            appendJsonString(out, user.name.value_or(std::string_view()));
+            out += ",\"createdAt\":";
+            appendTimestamp(out, user.createdAt, stamp);
+            out += ",\"updatedAt\":";
+            appendTimestamp(out, user.updatedAt, stamp);
+            out += '}';
+        }
+        out += ']';
+        return out;
+    }
+
+private:
+    struct Entry {
+        std::int64_t createdAt;
+        std::int64_t updatedAt;
+        std::int32_t id;
+        std::uint32_t emailOffset;
+        std::uint32_t emailLength;
+        std::uint32_t nameOffset;
+        std::uint32_t nameLength;
+    };
+
+    static constexpr std::uint32_t NO_NAME = 0xFFFFFFFFu;
+    static constexpr std::int64_t NO_TIMESTAMP = INT64_MIN;
+
+    static void appendTimestamp(std::string& out, const std::optional<std::int64_t>& epochMs,
+                                char (&stamp)[timestamp::FORMATTED_SIZE]) {
+        if (!epochMs.has_value()) {
+            out += "null";
+            return;
+        }
+        timestamp::format(epochMs.value(), stamp);
+        out += '"';
+        out.append(stamp, sizeof(stamp));
+        out += '"';
+    }
+
+    void intern(std::string_view text, std::uint32_t& offset, std::uint32_t& length) {
+        offset = static_cast<std::uint32_t>(pool_.size());
+        length = static_cast<std::uint32_t>(text.size());
+        pool_.append(text.data(), text.size());
+    }
+
+    std::vector<Entry> entries_;
+    std::string pool_;
+};
+
 /**
  * @brief DTO for creating a new user
  */
@@ -78,4 +304,12 @@ struct UpdateUserDto {
     }
 };
 
+/**
+ * @brief Outcome of one row of a batch create: the new user or why it was rejected
+ */
+struct BatchCreateResult {
+    std::optional<User> user;
+    std::string error;
+};
+
 } // namespace vicrow
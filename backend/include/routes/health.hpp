@@ -2,6 +2,7 @@
 
 #include <crow.h>
 #include "services/prisma_client.hpp"
+#include "services/user_search_index.hpp"
 
 namespace vicrow {
 namespace routes {
@@ -10,14 +11,15 @@ namespace routes {
  * @brief Register health check routes
  */
 template<typename App>
-void registerHealthRoutes(App& app, PrismaClient& prisma) {
+void registerHealthRoutes(App& app, PrismaClient& prisma, const UserSearchIndex& search) {
     CROW_ROUTE(app, "/api/health")
-    ([&prisma]() -> crow::response {
+    ([&prisma, &search]() -> crow::response {
         crow::json::wvalue response;
         response["status"] = "ok";
         response["message"] = "Vicrow Backend is running";
         response["timestamp"] = std::to_string(std::time(nullptr));
         response["database"] = prisma.isConnected() ? "connected" : "disconnected";
+        response["searchIndex"] = search.isReady() ? "ready" : "warming";
         
         crow::response res(response);
         res.add_header("Content-Type", "application/json");
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <crow.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "services/prisma_client.hpp"
+#include "models/post.hpp"
+
+namespace vicrow {
+namespace routes {
+
+/**
+ * @brief Read a create-post body into a DTO, or return why it is invalid
+ */
+inline std::optional<std::string> readCreatePost(const crow::json::rvalue& body, CreatePostDto& dto) {
+    using crow::json::type;
+    if (!body.has("title") || !body.has("authorId")) {
+        return std::string("Title and authorId are required");
+    }
+    if (body["title"].t() != type::String) {
+        return std::string("title must be a string");
+    }
+    if (body["authorId"].t() != type::Number || body["authorId"].nt() == crow::json::num_type::Floating_point) {
+        return std::string("authorId must be an integer");
+    }
+    dto.title = body["title"].s();
+    dto.authorId = static_cast<int>(body["authorId"].i());
+
+    if (body.has("content") && body["content"].t() != type::Null) {
+        if (body["content"].t() != type::String) {
+            return std::string("content must be a string or null");
+        }
+        dto.content = body["content"].s();
+    }
+    if (body.has("published")) {
+        if (body["published"].t() != type::True && body["published"].t() != type::False) {
+            return std::string("published must be a boolean");
+        }
+        dto.published = body["published"].b();
+    }
+    if (body.has("tags")) {
+        if (body["tags"].t() != type::List) {
+            return std::string("tags must be an array of strings");
+        }
+        for (const auto& tag : body["tags"]) {
+            if (tag.t() != type::String) {
+                return std::string("tags must be an array of strings");
+            }
+            dto.tags.push_back(tag.s());
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Register post, comment and tag routes
+ *
+ * Post reads accept `?include=author,tags,comments` and `?fields=` sparse
+ * fieldsets (`fields=id,title,author.name`). Both are resolved in one
+ * upstream query and only the requested columns are serialized.
+ */
+template<typename App>
+void registerPostRoutes(App& app, PrismaClient& prisma) {
+    // GET /api/posts - Get all posts
+    CROW_ROUTE(app, "/api/posts")
+    ([&prisma](const crow::request& req) -> crow::response {
+        try {
+            auto query = PostQuery::parse(req.url_params.get("include"), req.url_params.get("fields"));
+            auto posts = prisma.findManyPosts(query);
+
+            json postList = json::array();
+            for (const auto& post : posts) {
+                postList.push_back(post.to_json(query));
+            }
+
+            crow::response res(200, postList.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::invalid_argument& e) {
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(400, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::exception& e) {
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(500, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        }
+    });
+
+    // GET /api/posts/:id - Get post by ID
+    CROW_ROUTE(app, "/api/posts/<int>")
+    ([&prisma](const crow::request& req, int id) -> crow::response {
+        try {
+            auto query = PostQuery::parse(req.url_params.get("include"), req.url_params.get("fields"));
+            auto post = prisma.findPostById(id, query);
+            if (!post.has_value()) {
+                crow::json::wvalue error;
+                error["error"] = "Post not found";
+                crow::response res(404, error.dump());
+                res.add_header("Content-Type", "application/json");
+                return res;
+            }
+
+            crow::response res(200, post->to_json(query).dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::invalid_argument& e) {
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(400, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::exception& e) {
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(500, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        }
+    });
+
+    // POST /api/posts - Create post
+    CROW_ROUTE(app, "/api/posts").methods(crow::HTTPMethod::POST)
+    ([&prisma](const crow::request& req) -> crow::response {
+        try {
+            auto body = crow::json::load(req.body);
+            CreatePostDto dto;
+            std::optional<std::string> invalid;
+            if (!body || body.t() != crow::json::type::Object) {
+                invalid = "Invalid JSON body";
+            } else {
+                invalid = readCreatePost(body, dto);
+            }
+            if (invalid.has_value()) {
+                crow::json::wvalue error;
+                error["error"] = invalid.value();
+                crow::response res(400, error.dump());
+                res.add_header("Content-Type", "application/json");
+                return res;
+            }
+
+            auto post = prisma.createPost(dto);
+
+            // Upstream returns the post with its author and tags
+            PostQuery query;
+            query.postFields = Post::ALL_FIELDS;
+            query.authorFields = User::ALL_FIELDS;
+            query.tagFields = Tag::ALL_FIELDS;
+
+            crow::response res(201, post.to_json(query).dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const PrismaError& e) {
+            // Pass upstream client errors (missing post or author) through
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(e.status() < 500 ? e.status() : 500, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::exception& e) {
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(500, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        }
+    });
+
+    // GET /api/posts/:id/comments - Get comments on a post
+    CROW_ROUTE(app, "/api/posts/<int>/comments")
+    ([&prisma](int id) -> crow::response {
+        try {
+            auto comments = prisma.findCommentsByPost(id);
+
+            json commentList = json::array();
+            for (const auto& comment : comments) {
+                commentList.push_back(comment.to_json());
+            }
+
+            crow::response res(200, commentList.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::exception& e) {
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(500, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        }
+    });
+
+    // POST /api/posts/:id/comments - Add a comment to a post
+    CROW_ROUTE(app, "/api/posts/<int>/comments").methods(crow::HTTPMethod::POST)
+    ([&prisma](const crow::request& req, int id) -> crow::response {
+        try {
+            auto body = crow::json::load(req.body);
+            if (!body || body.t() != crow::json::type::Object || !body.has("content")
+                || body["content"].t() != crow::json::type::String) {
+                crow::json::wvalue error;
+                error["error"] = "Content is required";
+                crow::response res(400, error.dump());
+                res.add_header("Content-Type", "application/json");
+                return res;
+            }
+
+            CreateCommentDto dto;
+            dto.content = body["content"].s();
+
+            auto comment = prisma.createComment(id, dto);
+
+            crow::response res(201, comment.to_json().dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const PrismaError& e) {
+            // Pass upstream client errors (missing post or author) through
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(e.status() < 500 ? e.status() : 500, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::exception& e) {
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(500, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        }
+    });
+
+    // GET /api/tags - Get all tags
+    CROW_ROUTE(app, "/api/tags")
+    ([&prisma]() -> crow::response {
+        try {
+            auto tags = prisma.findManyTags();
+
+            json tagList = json::array();
+            for (const auto& tag : tags) {
+                tagList.push_back(tag.to_json());
+            }
+
+            crow::response res(200, tagList.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::exception& e) {
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(500, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        }
+    });
+}
+
+} // namespace routes
+} // namespace vicrow
@@ -1,35 +1,204 @@
 #pragma once
 
 #include <crow.h>
+#include <algorithm>
+#include <cstdint>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <optional>
 #include "services/prisma_client.hpp"
+#include "services/user_events.hpp"
+#include "services/user_search_index.hpp"
+#include "services/email_filter.hpp"
+#include "services/user_export.hpp"
+#include "services/user_import.hpp"
+#include "models/url_encoding.hpp"
 #include "models/user.hpp"
 
 namespace vicrow {
 namespace routes {
 
 /**
- * @brief Register user CRUD routes
+ * @brief Set a user timestamp field: ISO-8601 if present, null if not
+ */
+inline void setTimestamp(crow::json::wvalue& field, const std::optional<std::int64_t>& epochMs) {
+    if (epochMs.has_value()) {
+        field = timestamp::format(epochMs.value());
+    } else {
+        field = nullptr;
+    }
+}
+
+/**
+ * @brief Register user CRUD, search, email lookup, bulk transfer and change feed routes
+ *
+ * Successful writes, including bulk imports, update the search index (which
+ * keeps the email filter in step) and are published to the event hub, which streams them to
+ * `/api/users/stream` WebSocket subscribers.
  */
 template<typename App>
-void registerUserRoutes(App& app, PrismaClient& prisma) {
+void registerUserRoutes(App& app, PrismaClient& prisma, UserEventHub& events,
+                        UserSearchIndex& search, EmailFilter& emails, UserExporter& exporter) {
     // GET /api/users - Get all users
     CROW_ROUTE(app, "/api/users")
     ([&prisma]() -> crow::response {
         try {
             auto users = prisma.findManyUsers();
-            crow::json::wvalue::list userList;
             
-            for (const auto& user : users) {
-                crow::json::wvalue u;
-                u["id"] = user.id;
-                u["email"] = user.email;
-                u["name"] = user.name.has_value() ? user.name.value() : "";
-                u["createdAt"] = user.createdAt;
-                u["updatedAt"] = user.updatedAt;
-                userList.push_back(std::move(u));
+            crow::response res(200, users.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::exception& e) {
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(500, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        }
+    });
+
+    // GET /api/users/export - Download all users as NDJSON
+    CROW_ROUTE(app, "/api/users/export")
+    ([&exporter]() -> crow::response {
+        try {
+            crow::response res;
+            res.set_static_file_info(exporter.exportToFile());
+            res.set_header("Content-Type", "application/x-ndjson");
+            res.set_header("Content-Disposition", "attachment; filename=\"users.ndjson\"");
+            return res;
+        } catch (const ExportBusyError& e) {
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(503, error.dump());
+            res.add_header("Retry-After", std::to_string(e.retryAfter().count()));
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::exception& e) {
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(502, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        }
+    });
+
+    // POST /api/users/import - Create users from an NDJSON body
+    CROW_ROUTE(app, "/api/users/import").methods(crow::HTTPMethod::POST)
+    ([importer = UserImporter(prisma), &events, &search](const crow::request& req) -> crow::response {
+        auto report = importer.run(req.body, [&](const User& user) {
+            search.upsert(user);
+            events.publishCreated(user);
+        });
+
+        crow::response res(report.aborted.has_value() ? 502 : 200, report.to_json().dump());
+        res.add_header("Content-Type", "application/json");
+        return res;
+    });
+
+    // GET /api/users/search?q=&limit= - Search users by email or name
+    CROW_ROUTE(app, "/api/users/search")
+    ([&search](const crow::request& req) -> crow::response {
+        const char* q = req.url_params.get("q");
+        if (q == nullptr) {
+            crow::json::wvalue error;
+            error["error"] = "Query parameter q is required";
+            crow::response res(400, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        }
+
+        std::size_t limit = 10;
+        if (const char* param = req.url_params.get("limit")) {
+            char* end = nullptr;
+            unsigned long value = std::strtoul(param, &end, 10);
+            if (*param < '0' || *param > '9' || *end != '\0' || value == 0) {
+                crow::json::wvalue error;
+                error["error"] = "limit must be a positive integer";
+                crow::response res(400, error.dump());
+                res.add_header("Content-Type", "application/json");
+                return res;
             }
-            
-            crow::response res(crow::json::wvalue(userList));
+            limit = std::min<unsigned long>(value, 100);
+        }
+
+        if (!search.isReady()) {
+            crow::json::wvalue error;
+            error["error"] = "Search index is warming up";
+            crow::response res(503, error.dump());
+            res.add_header("Retry-After", "5");
+            res.add_header("Content-Type", "application/json");
+            return res;
+        }
+
+        auto users = search.search(q, limit);
+        crow::json::wvalue::list userList;
+
+        for (const auto& user : users) {
+            crow::json::wvalue u;
+            u["id"] = user.id;
+            u["email"] = user.email;
+            u["name"] = user.name.has_value() ? user.name.value() : "";
+            setTimestamp(u["createdAt"], user.createdAt);
+            setTimestamp(u["updatedAt"], user.updatedAt);
+            userList.push_back(std::move(u));
+        }
+
+        crow::response res{crow::json::wvalue(userList)};
+        res.add_header("Content-Type", "application/json");
+        return res;
+    });
+
+    // GET /api/users/email/:email - Get user by email
+    CROW_ROUTE(app, "/api/users/email/<string>")
+    ([&prisma, &emails](const std::string& rawEmail) -> crow::response {
+        try {
+            std::string email = decodePathSegment(rawEmail);
+
+            // A filter miss is definitive, so unknown emails never go upstream
+            std::optional<User> user;
+            if (emails.mightContain(email)) {
+                user = prisma.findUserByEmail(email);
+            }
+            if (!user.has_value()) {
+                crow::json::wvalue error;
+                error["error"] = "User not found";
+                crow::response res(404, error.dump());
+                res.add_header("Content-Type", "application/json");
+                return res;
+            }
+
+            crow::json::wvalue u;
+            u["id"] = user->id;
+            u["email"] = user->email;
+            u["name"] = user->name.has_value() ? user->name.value() : "";
+            setTimestamp(u["createdAt"], user->createdAt);
+            setTimestamp(u["updatedAt"], user->updatedAt);
+
+            crow::response res(u);
+            res.add_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::exception& e) {
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(500, error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        }
+    });
+
+    // GET /api/users/email/:email/available - Check whether an email is free for sign-up
+    CROW_ROUTE(app, "/api/users/email/<string>/available")
+    ([&prisma, &emails](const std::string& rawEmail) -> crow::response {
+        try {
+            std::string email = decodePathSegment(rawEmail);
+            bool available = !emails.mightContain(email) || !prisma.findUserByEmail(email).has_value();
+
+            crow::json::wvalue result;
+            result["email"] = email;
+            result["available"] = available;
+
+            crow::response res(result);
             res.add_header("Content-Type", "application/json");
             return res;
         } catch (const std::exception& e) {
@@ -58,8 +227,8 @@ void registerUserRoutes(App& app, PrismaClient& prisma) {
             u["id"] = user->id;
             u["email"] = user->email;
             u["name"] = user->name.has_value() ? user->name.value() : "";
-            u["createdAt"] = user->createdAt;
-            u["updatedAt"] = user->updatedAt;
+            setTimestamp(u["createdAt"], user->createdAt);
+            setTimestamp(u["updatedAt"], user->updatedAt);
             
             crow::response res(u);
             res.add_header("Content-Type", "application/json");
@@ -75,7 +244,7 @@ void registerUserRoutes(App& app, PrismaClient& prisma) {
 
     // POST /api/users - Create user
     CROW_ROUTE(app, "/api/users").methods(crow::HTTPMethod::POST)
-    ([&prisma](const crow::request& req) -> crow::response {
+    ([&prisma, &events, &search, &emails](const crow::request& req) -> crow::response {
         try {
             auto body = crow::json::load(req.body);
             if (!body) {
@@ -91,19 +260,40 @@ void registerUserRoutes(App& app, PrismaClient& prisma) {
             if (body.has("name") && body["name"].t() != crow::json::type::Null) {
                 dto.name = body["name"].s();
             }
+
+            // Only possible duplicates pay for the extra lookup; new emails go straight to create
+            if (emails.isReady() && emails.mightContain(dto.email)
+                && prisma.findUserByEmail(dto.email).has_value()) {
+                crow::json::wvalue error;
+                error["error"] = "Email already exists";
+                crow::response res(409, error.dump());
+                res.add_header("Content-Type", "application/json");
+                return res;
+            }
             
             auto user = prisma.createUser(dto);
+            search.upsert(user);
+            events.publishCreated(user);
             
             crow::json::wvalue u;
             u["id"] = user.id;
             u["email"] = user.email;
             u["name"] = user.name.has_value() ? user.name.value() : "";
-            u["createdAt"] = user.createdAt;
-            u["updatedAt"] = user.updatedAt;
+            setTimestamp(u["createdAt"], user.createdAt);
+            setTimestamp(u["updatedAt"], user.updatedAt);
             
             crow::response res(201, u.dump());
             res.add_header("Content-Type", "application/json");
             return res;
+        } catch (const PrismaError& e) {
+            // A duplicate the filter pre-check missed (filter not ready, or a
+            // racing create) gets the same 409 as one it caught
+            bool duplicate = e.status() == 400 && std::string(e.what()) == "Email already exists";
+            crow::json::wvalue error;
+            error["error"] = e.what();
+            crow::response res(duplicate ? 409 : (e.status() < 500 ? e.status() : 500), error.dump());
+            res.add_header("Content-Type", "application/json");
+            return res;
         } catch (const std::exception& e) {
             crow::json::wvalue error;
             error["error"] = e.what();
@@ -115,7 +305,7 @@ void registerUserRoutes(App& app, PrismaClient& prisma) {
 
     // PUT /api/users/:id - Update user
     CROW_ROUTE(app, "/api/users/<int>").methods(crow::HTTPMethod::PUT)
-    ([&prisma](const crow::request& req, int id) -> crow::response {
+    ([&prisma, &events, &search](const crow::request& req, int id) -> crow::response {
         try {
             auto body = crow::json::load(req.body);
             if (!body) {
@@ -142,13 +332,15 @@ void registerUserRoutes(App& app, PrismaClient& prisma) {
                 res.add_header("Content-Type", "application/json");
                 return res;
             }
+            search.upsert(*user);
+            events.publishUpdated(*user);
             
             crow::json::wvalue u;
             u["id"] = user->id;
             u["email"] = user->email;
             u["name"] = user->name.has_value() ? user->name.value() : "";
-            u["createdAt"] = user->createdAt;
-            u["updatedAt"] = user->updatedAt;
+            setTimestamp(u["createdAt"], user->createdAt);
+            setTimestamp(u["updatedAt"], user->updatedAt);
             
             crow::response res(u);
             res.add_header("Content-Type", "application/json");
@@ -164,7 +356,7 @@ void registerUserRoutes(App& app, PrismaClient& prisma) {
 
     // DELETE /api/users/:id - Delete user
     CROW_ROUTE(app, "/api/users/<int>").methods(crow::HTTPMethod::DELETE)
-    ([&prisma](int id) -> crow::response {
+    ([&prisma, &events, &search](int id) -> crow::response {
         try {
             bool deleted = prisma.deleteUser(id);
             if (!deleted) {
@@ -174,6 +366,8 @@ void registerUserRoutes(App& app, PrismaClient& prisma) {
                 res.add_header("Content-Type", "application/json");
                 return res;
             }
+            search.remove(id);
+            events.publishDeleted(id);
             
             crow::json::wvalue success;
             success["message"] = "User deleted successfully";
@@ -189,6 +383,62 @@ void registerUserRoutes(App& app, PrismaClient& prisma) {
             return res;
         }
     });
+
+    // WS /api/users/stream - Live user change feed
+    // Connect with ?since=<seq> to resume after the last event seen
+    CROW_WEBSOCKET_ROUTE(app, "/api/users/stream")
+        .onaccept([](const crow::request& req, void** userdata) -> bool {
+            // Stash the resume point for onopen as seq + 1 (0 = live only)
+            std::uintptr_t since = 0;
+            if (const char* param = req.url_params.get("since")) {
+                // strtoull reads "abc" as 0, which would replay the whole history
+                char* end = nullptr;
+                errno = 0;
+                unsigned long long value = std::strtoull(param, &end, 10);
+                if (*param < '0' || *param > '9' || *end != '\0' || errno == ERANGE
+                    || value >= std::numeric_limits<std::uintptr_t>::max()) {
+                    return false;
+                }
+                since = static_cast<std::uintptr_t>(value) + 1;
+            }
+            *userdata = reinterpret_cast<void*>(since);
+            return true;
+        })
+        .onopen([&events](crow::websocket::connection& conn) {
+            auto since = reinterpret_cast<std::uintptr_t>(conn.userdata());
+            events.subscribe(
+                reinterpret_cast<std::uintptr_t>(&conn),
+                since ? std::optional<std::uint64_t>(since - 1) : std::nullopt,
+                [&conn](const std::string& event) { conn.send_text(event); },
+                [&conn](const std::string& reason) { conn.close(reason); });
+        })
+        .onclose([&events](crow::websocket::connection& conn, const std::string&) {
+            events.unsubscribe(reinterpret_cast<std::uintptr_t>(&conn));
+        })
+        .onmessage([&events](crow::websocket::connection& conn, const std::string& data, bool isBinary) {
+            // The only client message is a cumulative ack: {"type":"ack","seq":N}
+            if (isBinary) {
+                return;
+            }
+            // Anything thrown here would escape into Crow's io loop and stall the
+            // connection, so malformed messages are checked and otherwise ignored
+            try {
+                auto message = crow::json::load(data);
+                if (!message || message.t() != crow::json::type::Object
+                    || !message.has("type") || message["type"].t() != crow::json::type::String
+                    || message["type"].s() != "ack"
+                    || !message.has("seq") || message["seq"].t() != crow::json::type::Number
+                    || message["seq"].nt() == crow::json::num_type::Floating_point) {
+                    return;
+                }
+                auto seq = message["seq"].i();
+                if (seq >= 0) {
+                    events.ack(reinterpret_cast<std::uintptr_t>(&conn), static_cast<std::uint64_t>(seq));
+                }
+            } catch (const std::exception&) {
+                // Ignored like any other malformed message
+            }
+        });
 }
 
 } // namespace routes
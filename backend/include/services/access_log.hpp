@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace vicrow {
+
+/**
+ * @brief Access log settings
+ */
+struct AccessLogConfig {
+    std::string path = "access.log";      // "-" writes to stdout
+    std::size_t ringCapacity = 4096;      // records per worker thread (rounded up to a power of two)
+    std::uint32_t sampleEvery = 1;        // log 1 in N successful requests; errors are always logged
+    std::size_t maxFileBytes = 64u << 20; // rotate when the file grows past this
+    std::size_t maxFiles = 5;             // rotated files kept as path.1 .. path.N
+    std::chrono::milliseconds flushInterval{200};
+};
+
+/**
+ * @brief One access log entry, fixed-size so ring slots are plain copies
+ */
+struct AccessLogRecord {
+    std::int64_t timestampMs;
+    std::uint32_t latencyUs;
+    std::uint32_t upstreamUs;
+    std::uint64_t bytes;
+    std::uint16_t status;
+    char method[8];
+    char path[110];
+};
+
+/**
+ * @brief Asynchronous structured access log
+ *
+ * Each worker thread writes into its own single-producer ring buffer, so
+ * logging a request is a few stores and never takes a lock or touches the
+ * file. A background thread drains all rings in batches and writes JSON
+ * lines to the log file (or stdout), rotating it by size. When a ring is
+ * full the record is dropped and counted instead of blocking the worker.
+ */
+class AccessLog {
+public:
+    explicit AccessLog(const AccessLogConfig& config = AccessLogConfig());
+    ~AccessLog();
+
+    AccessLog(const AccessLog&) = delete;
+    AccessLog& operator=(const AccessLog&) = delete;
+
+    /**
+     * @brief Open the output and start the writer thread
+     * @return false if the log file cannot be opened
+     */
+    bool start();
+
+    /**
+     * @brief Flush everything still buffered and stop the writer thread
+     */
+    void stop();
+
+    /**
+     * @brief Record a finished request from the calling worker thread
+     */
+    void record(std::string_view method, std::string_view path, int status,
+                std::uint32_t latencyUs, std::uint32_t upstreamUs, std::uint64_t bytes);
+
+    /**
+     * @brief Records dropped because a ring was full
+     */
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Ring {
+        explicit Ring(std::size_t capacity) : slots(capacity), mask(capacity - 1) {}
+
+        std::vector<AccessLogRecord> slots;
+        const std::size_t mask;
+        alignas(64) std::atomic<std::uint64_t> head{0};   // written by the worker
+        alignas(64) std::atomic<std::uint64_t> tail{0};   // written by the drain thread
+        std::uint64_t sampleCounter = 0;                  // worker-only
+    };
+
+    Ring* threadRing();
+    void run();
+    void drain();
+    void write(const std::string& batch);
+    void rotate();
+
+    AccessLogConfig config_;
+    std::size_t ringCapacity_;
+    const std::uint64_t generation_;   // unique per instance; keys the per-thread ring cache
+
+    std::mutex ringsMutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+
+    std::atomic<std::uint64_t> dropped_{0};
+    std::uint64_t reportedDropped_ = 0;
+
+    std::FILE* file_ = nullptr;
+    std::size_t fileBytes_ = 0;
+
+    std::mutex runMutex_;
+    std::condition_variable wake_;
+    bool running_ = false;
+    std::thread writer_;
+};
+
+} // namespace vicrow
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+namespace vicrow {
+
+/**
+ * @brief Cuckoo filter over user emails
+ *
+ * Answers "is this email definitely not registered?" without going upstream.
+ * Each email is stored as a 16-bit fingerprint in one of two candidate
+ * buckets of four slots, so a lookup compares against at most 8 fingerprints
+ * and the false positive rate is about 8 x load / 65,536. A rebuild sizes
+ * the filter to at most half full, about 0.005% (1 in 20,000); it rises to
+ * about 0.01% if the user count doubles before the next restart. Unlike a
+ * Bloom filter it supports removal when a user is deleted or changes email.
+ *
+ * The filter is filled and kept in sync by UserSearchIndex (see
+ * attachEmailFilter). Until it is warmed, or if it ever overflows, it
+ * reports every email as a possible match so callers fall back to Prisma.
+ */
+class EmailFilter {
+public:
+    /**
+     * @brief Replace the filter contents with the given emails
+     *
+     * Sized for at least twice the current count so it can absorb growth
+     * until the next restart.
+     */
+    void rebuild(const std::vector<std::string_view>& emails);
+
+    /**
+     * @brief Record a newly registered email
+     */
+    void add(std::string_view email);
+
+    /**
+     * @brief Forget an email that was previously added
+     *
+     * Only call this for emails known to be in the filter; removing an
+     * email that was never added can evict another email's fingerprint.
+     */
+    void remove(std::string_view email);
+
+    /**
+     * @brief False only if the email is definitely not registered
+     */
+    bool mightContain(std::string_view email) const;
+
+    /**
+     * @brief Whether the filter has been warmed and can rule emails out
+     */
+    bool isReady() const;
+
+    std::size_t size() const;
+
+private:
+    static constexpr std::size_t SLOTS_PER_BUCKET = 4;
+    static constexpr int MAX_KICKS = 500;
+
+    struct Key {
+        std::size_t bucket;
+        std::uint16_t fingerprint;
+    };
+
+    Key keyFor(std::string_view email) const;
+    std::size_t altBucket(std::size_t bucket, std::uint16_t fingerprint) const;
+    bool insertLocked(Key key);
+    bool removeFrom(std::size_t bucket, std::uint16_t fingerprint);
+    bool bucketContains(std::size_t bucket, std::uint16_t fingerprint) const;
+
+    mutable std::shared_mutex mutex_;
+    std::vector<std::uint16_t> slots_;   // 0 marks an empty slot
+    std::size_t bucketMask_ = 0;
+    std::size_t count_ = 0;
+    bool ready_ = false;
+    bool overflowed_ = false;
+};
+
+} // namespace vicrow
@@ -1,15 +1,36 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <optional>
+#include <stdexcept>
 #include <nlohmann/json.hpp>
 #include "models/user.hpp"
+#include "models/post.hpp"
 
 namespace vicrow {
 
 using json = nlohmann::json;
 
+/**
+ * @brief Error response from the Prisma service
+ *
+ * Carries the upstream HTTP status so routes can pass 4xx answers (such as
+ * a missing post) through instead of reporting them as server errors.
+ */
+class PrismaError : public std::runtime_error {
+public:
+    PrismaError(int status, const std::string& message)
+        : std::runtime_error(message), status_(status) {}
+
+    int status() const { return status_; }
+
+private:
+    int status_;
+};
+
 /**
  * @brief Prisma Client for database operations
  * 
@@ -37,13 +58,51 @@ public:
     void disconnect();
 
     // User CRUD operations
-    std::vector<User> findManyUsers();
+    UserList findManyUsers();
     std::optional<User> findUserById(int id);
+    /**
+     * @brief Look up a user by email
+     * @return nullopt only if Prisma answers 404; other failures throw
+     */
     std::optional<User> findUserByEmail(const std::string& email);
     User createUser(const CreateUserDto& dto);
     std::optional<User> updateUser(int id, const UpdateUserDto& dto);
     bool deleteUser(int id);
 
+    // Bulk user operations
+    /**
+     * @brief Create users in one upstream call
+     *
+     * Results line up with the input rows. Rows whose email is already
+     * registered come back with an error instead of failing the batch.
+     */
+    std::vector<BatchCreateResult> createManyUsers(const std::vector<CreateUserDto>& users);
+
+    /**
+     * @brief Download every user as NDJSON straight into a file
+     *
+     * The Prisma service streams the rows from a cursor and curl writes
+     * them to disk, so the export never passes through this process's memory.
+     * @return Number of bytes written
+     */
+    std::uint64_t exportUsers(const std::string& path);
+
+    // Post operations
+    /**
+     * @brief Fetch posts with their relations in a single upstream query
+     *
+     * The query's columns and includes are sent as a Prisma `select`, so only
+     * the requested columns are read from the database.
+     */
+    std::vector<Post> findManyPosts(const PostQuery& query);
+    std::optional<Post> findPostById(int id, const PostQuery& query);
+    Post createPost(const CreatePostDto& dto);
+
+    // Comment and tag operations
+    std::vector<Comment> findCommentsByPost(int postId);
+    Comment createComment(int postId, const CreateCommentDto& dto);
+    std::vector<Tag> findManyTags();
+
     /**
      * @brief Get the Prisma service URL
      */
@@ -54,20 +113,35 @@ public:
      */
     void setServiceUrl(const std::string& url) { serviceUrl_ = url; }
 
+    /**
+     * @brief Microseconds the calling thread has waited on the Prisma service
+     * since the last reset (used for access logging)
+     */
+    static std::uint64_t threadUpstreamMicros();
+    static void resetThreadUpstreamMicros();
+
 private:
     std::string serviceUrl_;
-    bool connected_;
+    std::atomic<bool> connected_;   // read by routes, set by the cache warmer
 
     /**
      * @brief Execute HTTP request to Prisma service
      */
     json executeQuery(const std::string& endpoint, const std::string& method = "GET", 
                       const json& body = json::object());
+
+    /**
+     * @brief Execute HTTP request and return the unparsed 2xx body
+     *
+     * Error statuses are thrown as PrismaError like executeQuery.
+     */
+    std::string executeRaw(const std::string& endpoint, const std::string& method, const json& body,
+                           int& status);
     
     /**
-     * @brief Execute a shell command and return output
+     * @brief Execute a shell command, feeding it input on stdin, and return its output
      */
-    std::string executeCommand(const std::string& command);
+    std::string executeCommand(const std::string& command, const std::string& input = "");
 };
 
 } // namespace vicrow
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "services/prisma_client.hpp"
+#include "services/user_search_index.hpp"
+
+namespace vicrow {
+
+/**
+ * @brief Builds the in-memory user caches from Prisma, retrying until it succeeds
+ *
+ * The search index (and the email filter attached to it) needs one full
+ * user list before it can answer. If Prisma is unreachable at startup the warmer keeps retrying in
+ * the background (reconnecting first), so the caches come up as soon as the
+ * service does instead of staying empty for the life of the process.
+ */
+class UserCacheWarmer {
+public:
+    UserCacheWarmer(PrismaClient& prisma, UserSearchIndex& search,
+                    std::chrono::seconds retryInterval = std::chrono::seconds(5));
+    ~UserCacheWarmer();
+
+    UserCacheWarmer(const UserCacheWarmer&) = delete;
+    UserCacheWarmer& operator=(const UserCacheWarmer&) = delete;
+
+    /**
+     * @brief Try once on the calling thread; on failure keep retrying in the background
+     * @return true if the caches were warmed by the first attempt
+     */
+    bool start();
+
+    /**
+     * @brief Stop retrying
+     */
+    void stop();
+
+    bool isWarm() const { return warm_.load(std::memory_order_acquire); }
+
+private:
+    bool attempt();
+    void run();
+
+    PrismaClient& prisma_;
+    UserSearchIndex& search_;
+    std::chrono::seconds retryInterval_;
+
+    std::atomic<bool> warm_{false};
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool running_ = false;
+    std::thread worker_;
+};
+
+} // namespace vicrow
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+#include "models/user.hpp"
+
+namespace vicrow {
+
+using json = nlohmann::json;
+
+/**
+ * @brief Fan-out hub for user create/update/delete events
+ *
+ * Writers call publish*() after a successful upstream write. Publishing only
+ * appends the serialized event to a bounded history ring and wakes the
+ * dispatcher thread, so the write path never waits on subscribers.
+ *
+ * The dispatcher delivers events to every subscriber from its own cursor.
+ * Delivery is flow-controlled by acks: at most maxLag events may be sent
+ * but unacknowledged, after which the subscriber is paused instead of
+ * letting the socket's write queue grow. A subscriber that stays paused
+ * longer than ackTimeout, or whose next event falls out of history, is
+ * evicted as a slow consumer. Subscribers may resume from a sequence number
+ * as long as it is still in the history ring; otherwise (or if it is ahead
+ * of the head, e.g. after a restart) they receive a `reset` event and
+ * should refetch the user list.
+ */
+class UserEventHub {
+public:
+    using SendFn = std::function<void(const std::string&)>;
+    using CloseFn = std::function<void(const std::string&)>;
+
+    explicit UserEventHub(std::size_t historySize = 4096,
+                          std::size_t maxLag = 1024,
+                          std::size_t maxBatch = 256,
+                          std::chrono::milliseconds ackTimeout = std::chrono::seconds(30));
+    ~UserEventHub();
+
+    UserEventHub(const UserEventHub&) = delete;
+    UserEventHub& operator=(const UserEventHub&) = delete;
+
+    /**
+     * @brief Start the dispatcher thread
+     */
+    void start();
+
+    /**
+     * @brief Stop the dispatcher thread and drop all subscribers
+     */
+    void stop();
+
+    void publishCreated(const User& user);
+    void publishUpdated(const User& user);
+    void publishDeleted(int id);
+
+    /**
+     * @brief Register a subscriber
+     * @param key Caller-chosen unique key (e.g. the connection address)
+     * @param since Deliver events with a sequence greater than this;
+     *              std::nullopt starts at the live head
+     * @param send Called with each serialized event; must not block
+     * @param close Called with a reason when the subscriber is evicted
+     */
+    void subscribe(std::uintptr_t key, std::optional<std::uint64_t> since,
+                   SendFn send, CloseFn close);
+
+    /**
+     * @brief Record that a subscriber has processed events up to seq
+     *
+     * Acks are cumulative; stale or out-of-range values are clamped.
+     */
+    void ack(std::uintptr_t key, std::uint64_t seq);
+
+    /**
+     * @brief Remove a subscriber; unknown keys are ignored
+     */
+    void unsubscribe(std::uintptr_t key);
+
+    /**
+     * @brief Sequence number of the most recent event (0 if none)
+     */
+    std::uint64_t lastSequence() const;
+
+    std::size_t subscriberCount() const;
+
+private:
+    struct Event {
+        std::uint64_t seq;
+        std::shared_ptr<const std::string> payload;
+    };
+
+    struct Subscriber {
+        std::uint64_t nextSeq;
+        std::uint64_t acked;   // highest sequence the client has acknowledged
+        std::chrono::steady_clock::time_point pausedSince;   // epoch = not paused
+        SendFn send;
+        CloseFn close;
+    };
+
+    void publish(const char* type, json data);
+    void run();
+
+    const std::size_t historySize_;
+    const std::size_t maxLag_;
+    const std::size_t maxBatch_;
+    const std::chrono::milliseconds ackTimeout_;
+
+    // History ring, guarded by historyMutex_; publishers only touch this
+    mutable std::mutex historyMutex_;
+    std::condition_variable wake_;
+    std::deque<Event> history_;
+    std::uint64_t lastSeq_ = 0;
+    bool pending_ = false;
+    bool running_ = false;
+
+    // Subscribers, guarded by subscribersMutex_; only the dispatcher and
+    // (un)subscribe touch this, so fan-out never blocks publishers
+    mutable std::mutex subscribersMutex_;
+    std::unordered_map<std::uintptr_t, Subscriber> subscribers_;
+
+    std::thread dispatcher_;
+};
+
+} // namespace vicrow
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include "services/prisma_client.hpp"
+
+namespace vicrow {
+
+/**
+ * @brief Every spool slot is taken; the client should retry later
+ */
+class ExportBusyError : public std::runtime_error {
+public:
+    ExportBusyError(std::chrono::seconds retryAfter)
+        : std::runtime_error("Too many exports in progress"), retryAfter_(retryAfter) {}
+
+    std::chrono::seconds retryAfter() const { return retryAfter_; }
+
+private:
+    std::chrono::seconds retryAfter_;
+};
+
+/**
+ * @brief Spools NDJSON user exports to disk for streaming to clients
+ *
+ * Crow cannot stream a response from a generator, but it does send static
+ * files in fixed-size chunks. Each export is downloaded from the Prisma
+ * service's cursor straight into a spool file, which the route hands to
+ * Crow, so memory use stays constant however many users there are. This is
+ * spooling, not end-to-end streaming: the client receives nothing until the
+ * whole file has been written.
+ *
+ * Spool files are created exclusively (mode 0600) in a private directory
+ * made with mkdtemp (mode 0700), so other local users cannot read them or
+ * plant links in their place. Crow opens a static file by path only when it
+ * starts sending, so a spool cannot be unlinked as soon as the route returns.
+ * Instead it is kept for the retention period and removed by a later export
+ * (or with the directory when the exporter is destroyed), and at most
+ * maxSpoolFiles spools, in progress or retained, exist at once. That caps
+ * both concurrent upstream exports and the disk the spools can use.
+ */
+class UserExporter {
+public:
+    /**
+     * @param parent Directory to create the private spool directory in;
+     *               empty uses the system temp directory
+     */
+    explicit UserExporter(PrismaClient& prisma, std::string parent = "",
+                          std::chrono::seconds retention = std::chrono::seconds(60),
+                          std::size_t maxSpoolFiles = 4);
+    ~UserExporter();
+
+    UserExporter(const UserExporter&) = delete;
+    UserExporter& operator=(const UserExporter&) = delete;
+
+    /**
+     * @brief Export all users to a new spool file
+     * @return Path of the NDJSON file
+     * @throws ExportBusyError if maxSpoolFiles spools already exist
+     * @throws std::runtime_error if the spool file cannot be created or the upstream export fails
+     */
+    std::string exportToFile();
+
+private:
+    /**
+     * @brief Remove expired spools, returning how many remain and when the oldest expires
+     */
+    std::size_t prune(std::chrono::seconds& nextExpiry);
+
+    PrismaClient& prisma_;
+    std::string directory_;   // private spool directory; empty if it could not be created
+    std::string error_;       // why directory_ is empty
+    std::chrono::seconds retention_;
+    std::size_t maxSpoolFiles_;
+    std::mutex mutex_;        // makes counting and creating a spool one step
+    std::atomic<std::uint64_t> counter_{0};
+};
+
+} // namespace vicrow
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "services/prisma_client.hpp"
+#include "models/user.hpp"
+
+namespace vicrow {
+
+using json = nlohmann::json;
+
+/**
+ * @brief Bulk import limits
+ */
+struct UserImportConfig {
+    std::size_t batchRows = 500;          // rows per upstream call
+    std::size_t batchBytes = 64u << 10;   // serialized rows per call, under express.json's 100 kB body limit; larger rows are rejected
+    std::size_t maxErrors = 1000;         // per-line errors reported before truncating
+};
+
+/**
+ * @brief Why one NDJSON line was not imported
+ */
+struct ImportLineError {
+    std::size_t line;
+    std::string error;
+};
+
+/**
+ * @brief Result of a bulk import
+ */
+struct ImportReport {
+    std::size_t lines = 0;     // non-blank lines read
+    std::size_t created = 0;
+    std::size_t failed = 0;
+    std::vector<ImportLineError> errors;
+    bool errorsTruncated = false;
+    std::optional<std::string> aborted;   // set if the Prisma service failed mid-import
+
+    json to_json() const {
+        json j;
+        j["lines"] = lines;
+        j["created"] = created;
+        j["failed"] = failed;
+        json list = json::array();
+        for (const auto& e : errors) {
+            list.push_back({{"line", e.line}, {"error", e.error}});
+        }
+        j["errors"] = std::move(list);
+        j["errorsTruncated"] = errorsTruncated;
+        if (aborted.has_value()) {
+            j["aborted"] = aborted.value();
+        }
+        return j;
+    }
+};
+
+/**
+ * @brief Imports users from an NDJSON document (one `{"email","name"}` per line)
+ *
+ * Lines are parsed one at a time from the buffer and validated locally, then
+ * sent upstream in batches bounded by row count and bytes. Each batch waits
+ * for the Prisma service to finish before the next is parsed, so a slow
+ * database slows the import instead of piling up work. Bad lines and
+ * duplicate emails are reported by line number and do not stop the import;
+ * an upstream failure does.
+ */
+class UserImporter {
+public:
+    using CreatedFn = std::function<void(const User&)>;
+
+    explicit UserImporter(PrismaClient& prisma, const UserImportConfig& config = UserImportConfig());
+
+    /**
+     * @brief Import every line, calling onCreated for each user created
+     */
+    ImportReport run(std::string_view ndjson, const CreatedFn& onCreated) const;
+
+private:
+    PrismaClient& prisma_;
+    UserImportConfig config_;
+};
+
+} // namespace vicrow
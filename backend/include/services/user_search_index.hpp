@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "models/user.hpp"
+#include "services/email_filter.hpp"
+
+namespace vicrow {
+
+/**
+ * @brief In-memory search index over user email and name
+ *
+ * Queries of three or more characters are answered from a trigram index
+ * (posting lists intersected, then verified as real substrings). Shorter
+ * queries use a sorted term set for prefix matches on the email and on each
+ * word of the name. Matching is ASCII case-insensitive.
+ *
+ * The index is warmed from the full user list (retried in the background
+ * until Prisma is reachable) and kept in sync by the user write routes, so
+ * searches never go upstream. Writes that land before the first rebuild
+ * are replayed on top of it, so none are lost to the warm-up race, and a
+ * write older than the indexed copy (by updatedAt) is ignored. Reads take a
+ * shared lock; writes take an exclusive one.
+ */
+class UserSearchIndex {
+public:
+    /**
+     * @brief Keep an email filter in step with the indexed emails
+     *
+     * The filter is rebuilt from the index, after pending writes are replayed,
+     * and then updated under the index's write lock. Each removal therefore
+     * matches exactly one earlier add, even when writes to one user race.
+     * Call before the first rebuild.
+     */
+    void attachEmailFilter(EmailFilter& filter);
+
+    /**
+     * @brief Replace the whole index with the given users and mark it ready
+     */
+    void rebuild(const UserList& users);
+
+    /**
+     * @brief Whether the index has been built from the full user list
+     */
+    bool isReady() const;
+
+    /**
+     * @brief Insert a user, or re-index it if the id is already present
+     */
+    void upsert(const User& user);
+
+    /**
+     * @brief Remove a user; unknown ids are ignored
+     */
+    void remove(int id);
+
+    /**
+     * @brief Top matches for a query, best first
+     *
+     * Exact and prefix matches on the email rank above name prefix matches,
+     * which rank above plain substring matches.
+     */
+    std::vector<User> search(const std::string& query, std::size_t limit) const;
+
+    std::size_t size() const;
+
+private:
+    /**
+     * @brief One indexed user, with its strings packed into a single buffer
+     *
+     * text holds the email and name as given, followed by lowercase copies
+     * only when folding changed them. Trigrams and prefix terms are derived
+     * from the lowercase text again on removal instead of being stored.
+     */
+    struct Document {
+        std::optional<std::int64_t> createdAt;
+        std::optional<std::int64_t> updatedAt;
+        std::string text;
+        std::uint32_t emailLength = 0;
+        std::uint32_t nameLength = 0;
+        bool hasName = false;
+        bool folded = false;
+
+        std::string_view email() const { return std::string_view(text).substr(0, emailLength); }
+        std::string_view name() const { return std::string_view(text).substr(emailLength, nameLength); }
+        std::string_view lowerEmail() const {
+            return folded ? std::string_view(text).substr(emailLength + nameLength, emailLength) : email();
+        }
+        std::string_view lowerName() const {
+            return folded ? std::string_view(text).substr(2 * emailLength + nameLength, nameLength) : name();
+        }
+        User toUser(int id) const;
+    };
+
+    void insertLocked(const User& user);
+    void removeLocked(int id);
+
+    static int score(const Document& doc, std::string_view query);
+
+    mutable std::shared_mutex mutex_;
+    EmailFilter* emails_ = nullptr;
+    bool ready_ = false;
+    // Writes seen before the first rebuild; nullopt marks a removal
+    std::vector<std::pair<int, std::optional<User>>> pendingWrites_;
+    std::unordered_map<int, Document> documents_;
+    std::unordered_map<std::uint32_t, std::vector<int>> postings_;
+    std::set<std::pair<std::string, int>> terms_;
+};
+
+} // namespace vicrow
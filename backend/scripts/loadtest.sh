@@ -0,0 +1,68 @@
+#!/bin/bash
+
+# Vicrow Backend Load Test
+# Runs vicrow_backend against the stub Prisma service and drives it with
+# vicrow_loadgen. Extra arguments are passed to vicrow_loadgen.
+#
+# Environment:
+#   STUB_LATENCY_MS, STUB_JITTER_MS, STUB_ERROR_RATE, STUB_USERS, STUB_SEED
+#   STUB_PORT (default 3101), BACKEND_PORT (default 8180)
+#   LOADTEST_ACCESS_LOG (default off) - VICROW_ACCESS_LOG for the backend; set
+#     to a path to include access logging in the measurement
+#
+# Example: ./scripts/loadtest.sh --connections 128 --duration 30 --output before.json
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+BACKEND_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="${BUILD_DIR:-$BACKEND_DIR/build}"
+
+STUB_PORT="${STUB_PORT:-3101}"
+BACKEND_PORT="${BACKEND_PORT:-8180}"
+STUB_USERS="${STUB_USERS:-1000}"
+
+for binary in vicrow_backend vicrow_stub_prisma vicrow_loadgen; do
+    if [ ! -x "$BUILD_DIR/$binary" ]; then
+        echo "Missing $BUILD_DIR/$binary - build with: cmake -S backend -B backend/build && cmake --build backend/build"
+        exit 1
+    fi
+done
+
+cleanup() {
+    [ -n "$BACKEND_PID" ] && kill "$BACKEND_PID" 2>/dev/null || true
+    [ -n "$STUB_PID" ] && kill "$STUB_PID" 2>/dev/null || true
+}
+trap cleanup EXIT
+
+"$BUILD_DIR/vicrow_stub_prisma" \
+    --port "$STUB_PORT" \
+    --users "$STUB_USERS" \
+    --latency-ms "${STUB_LATENCY_MS:-0}" \
+    --jitter-ms "${STUB_JITTER_MS:-0}" \
+    --error-rate "${STUB_ERROR_RATE:-0}" \
+    --seed "${STUB_SEED:-42}" &
+STUB_PID=$!
+
+PRISMA_SERVICE_URL="http://localhost:$STUB_PORT" \
+VICROW_PORT="$BACKEND_PORT" \
+VICROW_RATE_LIMIT=off \
+VICROW_ACCESS_LOG="${LOADTEST_ACCESS_LOG:-off}" \
+    "$BUILD_DIR/vicrow_backend" > /dev/null &
+BACKEND_PID=$!
+
+# Wait for the backend to accept connections
+READY=0
+for _ in $(seq 1 50); do
+    if curl -s "http://localhost:$BACKEND_PORT/api/health" > /dev/null; then
+        READY=1
+        break
+    fi
+    sleep 0.1
+done
+if [ "$READY" -ne 1 ]; then
+    echo "Backend did not come up on port $BACKEND_PORT"
+    exit 1
+fi
+
+"$BUILD_DIR/vicrow_loadgen" --port "$BACKEND_PORT" --users "$STUB_USERS" "$@"
@@ -19,6 +19,10 @@ NC='\033[0m'
 # PID of running backend
 BACKEND_PID=""
 
+# The Vite dev proxy forwards from localhost with X-Forwarded-For, so rate
+# limits apply per browser client rather than to the proxy as a whole
+export VICROW_TRUSTED_PROXIES="${VICROW_TRUSTED_PROXIES:-127.0.0.1,::1}"
+
 cleanup() {
     echo ""
     echo -e "${YELLOW}Stopping backend...${NC}"
@@ -1,10 +1,24 @@
+#include <algorithm>
 #include <iostream>
 #include <csignal>
+#include <cstdlib>
+#include <string>
 #include <crow.h>
 
 #include "services/prisma_client.hpp"
+#include "services/user_events.hpp"
+#include "services/user_search_index.hpp"
+#include "services/email_filter.hpp"
+#include "services/user_cache_warmer.hpp"
+#include "services/user_export.hpp"
+#include "services/access_log.hpp"
+#include "middleware/access_log.hpp"
 #include "middleware/cors.hpp"
+#include "middleware/rate_limit.hpp"
 #include "models/user.hpp"
+#include "routes/health.hpp"
+#include "routes/users.hpp"
+#include "routes/posts.hpp"
 
 using namespace vicrow;
 
@@ -33,9 +47,16 @@ int main() {
     Vite + Crow Backend Framework
     )" << std::endl;
 
+    // Environment overrides (used by scripts/loadtest.sh)
+    const char* serviceUrl = std::getenv("PRISMA_SERVICE_URL");
+    const char* portEnv = std::getenv("VICROW_PORT");
+    const char* accessLogEnv = std::getenv("VICROW_ACCESS_LOG");
+    const char* accessLogSampleEnv = std::getenv("VICROW_ACCESS_LOG_SAMPLE");
+    int port = portEnv ? std::atoi(portEnv) : 8080;
+
     // Initialize Prisma client
     PrismaClient prisma;
-    prisma.setServiceUrl("http://localhost:3001");
+    prisma.setServiceUrl(serviceUrl ? serviceUrl : "http://localhost:3001");
     
     std::cout << "Connecting to Prisma service..." << std::endl;
     if (prisma.connect()) {
@@ -44,210 +65,69 @@ int main() {
         std::cout << "⚠ Could not connect to Prisma service. Start it with: npm run prisma:serve" << std::endl;
     }
 
-    // Create Crow app with CORS middleware
-    crow::App<CORSMiddleware> app;
-
-    // Health check route
-    CROW_ROUTE(app, "/api/health")
-    ([&prisma]() {
-        crow::json::wvalue response;
-        response["status"] = "ok";
-        response["message"] = "Vicrow Backend is running";
-        response["timestamp"] = std::to_string(std::time(nullptr));
-        response["database"] = prisma.isConnected() ? "connected" : "disconnected";
-        
-        crow::response res{response};
-        res.add_header("Content-Type", "application/json");
-        return res;
-    });
-
-    // GET /api/users - Get all users
-    CROW_ROUTE(app, "/api/users")
-    ([&prisma]() {
-        try {
-            auto users = prisma.findManyUsers();
-            crow::json::wvalue::list userList;
-            
-            for (const auto& user : users) {
-                crow::json::wvalue u;
-                u["id"] = user.id;
-                u["email"] = user.email;
-                u["name"] = user.name.has_value() ? user.name.value() : "";
-                u["createdAt"] = user.createdAt;
-                u["updatedAt"] = user.updatedAt;
-                userList.push_back(std::move(u));
-            }
-            
-            crow::response res{crow::json::wvalue(userList)};
-            res.add_header("Content-Type", "application/json");
-            return res;
-        } catch (const std::exception& e) {
-            crow::json::wvalue error;
-            error["error"] = e.what();
-            crow::response res(500, error.dump());
-            res.add_header("Content-Type", "application/json");
-            return res;
-        }
-    });
-
-    // GET /api/users/:id - Get user by ID
-    CROW_ROUTE(app, "/api/users/<int>")
-    ([&prisma](int id) {
-        try {
-            auto user = prisma.findUserById(id);
-            if (!user.has_value()) {
-                crow::json::wvalue error;
-                error["error"] = "User not found";
-                crow::response res(404, error.dump());
-                res.add_header("Content-Type", "application/json");
-                return res;
-            }
-            
-            crow::json::wvalue u;
-            u["id"] = user->id;
-            u["email"] = user->email;
-            u["name"] = user->name.has_value() ? user->name.value() : "";
-            u["createdAt"] = user->createdAt;
-            u["updatedAt"] = user->updatedAt;
-            
-            crow::response res{u};
-            res.add_header("Content-Type", "application/json");
-            return res;
-        } catch (const std::exception& e) {
-            crow::json::wvalue error;
-            error["error"] = e.what();
-            crow::response res(500, error.dump());
-            res.add_header("Content-Type", "application/json");
-            return res;
-        }
-    });
-
-    // POST /api/users - Create user
-    CROW_ROUTE(app, "/api/users").methods(crow::HTTPMethod::POST)
-    ([&prisma](const crow::request& req) {
-        try {
-            auto body = crow::json::load(req.body);
-            if (!body) {
-                crow::json::wvalue error;
-                error["error"] = "Invalid JSON body";
-                crow::response res(400, error.dump());
-                res.add_header("Content-Type", "application/json");
-                return res;
-            }
-            
-            CreateUserDto dto;
-            dto.email = body["email"].s();
-            if (body.has("name") && body["name"].t() != crow::json::type::Null) {
-                dto.name = body["name"].s();
-            }
-            
-            auto user = prisma.createUser(dto);
-            
-            crow::json::wvalue u;
-            u["id"] = user.id;
-            u["email"] = user.email;
-            u["name"] = user.name.has_value() ? user.name.value() : "";
-            u["createdAt"] = user.createdAt;
-            u["updatedAt"] = user.updatedAt;
-            
-            crow::response res(201, u.dump());
-            res.add_header("Content-Type", "application/json");
-            return res;
-        } catch (const std::exception& e) {
-            crow::json::wvalue error;
-            error["error"] = e.what();
-            crow::response res(500, error.dump());
-            res.add_header("Content-Type", "application/json");
-            return res;
-        }
-    });
-
-    // PUT /api/users/:id - Update user
-    CROW_ROUTE(app, "/api/users/<int>").methods(crow::HTTPMethod::PUT)
-    ([&prisma](const crow::request& req, int id) {
-        try {
-            auto body = crow::json::load(req.body);
-            if (!body) {
-                crow::json::wvalue error;
-                error["error"] = "Invalid JSON body";
-                crow::response res(400, error.dump());
-                res.add_header("Content-Type", "application/json");
-                return res;
-            }
-            
-            UpdateUserDto dto;
-            if (body.has("email") && body["email"].t() != crow::json::type::Null) {
-                dto.email = body["email"].s();
-            }
-            if (body.has("name") && body["name"].t() != crow::json::type::Null) {
-                dto.name = body["name"].s();
-            }
-            
-            auto user = prisma.updateUser(id, dto);
-            if (!user.has_value()) {
-                crow::json::wvalue error;
-                error["error"] = "User not found";
-                crow::response res(404, error.dump());
-                res.add_header("Content-Type", "application/json");
-                return res;
-            }
-            
-            crow::json::wvalue u;
-            u["id"] = user->id;
-            u["email"] = user->email;
-            u["name"] = user->name.has_value() ? user->name.value() : "";
-            u["createdAt"] = user->createdAt;
-            u["updatedAt"] = user->updatedAt;
-            
-            crow::response res{u};
-            res.add_header("Content-Type", "application/json");
-            return res;
-        } catch (const std::exception& e) {
-            crow::json::wvalue error;
-            error["error"] = e.what();
-            crow::response res(500, error.dump());
-            res.add_header("Content-Type", "application/json");
-            return res;
-        }
-    });
-
-    // DELETE /api/users/:id - Delete user
-    CROW_ROUTE(app, "/api/users/<int>").methods(crow::HTTPMethod::DELETE)
-    ([&prisma](int id) {
-        try {
-            bool deleted = prisma.deleteUser(id);
-            if (!deleted) {
-                crow::json::wvalue error;
-                error["error"] = "User not found";
-                crow::response res(404, error.dump());
-                res.add_header("Content-Type", "application/json");
-                return res;
-            }
-            
-            crow::json::wvalue success;
-            success["message"] = "User deleted successfully";
-            
-            crow::response res{success};
-            res.add_header("Content-Type", "application/json");
-            return res;
-        } catch (const std::exception& e) {
-            crow::json::wvalue error;
-            error["error"] = e.what();
-            crow::response res(500, error.dump());
-            res.add_header("Content-Type", "application/json");
-            return res;
-        }
-    });
+    // Warm the user search index and email filter, retrying in the background if Prisma is down
+    UserSearchIndex userSearch;
+    EmailFilter emailFilter;
+    userSearch.attachEmailFilter(emailFilter);
+    UserCacheWarmer cacheWarmer(prisma, userSearch);
+    if (!cacheWarmer.start()) {
+        std::cout << "⚠ User caches not warmed yet; retrying in the background" << std::endl;
+    }
+
+    // Bulk exports are spooled to the temp directory and streamed from disk
+    UserExporter userExporter(prisma);
+
+    // Start the user change feed dispatcher
+    UserEventHub userEvents;
+    userEvents.start();
+
+    // Start the asynchronous access log
+    AccessLogConfig accessLogConfig;
+    if (accessLogEnv) {
+        accessLogConfig.path = accessLogEnv;
+    }
+    if (accessLogSampleEnv) {
+        accessLogConfig.sampleEvery = static_cast<std::uint32_t>(std::max(1, std::atoi(accessLogSampleEnv)));
+    }
+    AccessLog accessLog(accessLogConfig);
+    bool accessLogEnabled = accessLogConfig.path != "off";
+    if (accessLogEnabled && !accessLog.start()) {
+        std::cout << "⚠ Could not open access log " << accessLogConfig.path << std::endl;
+        accessLogEnabled = false;
+    }
+
+    // Create Crow app with access logging, CORS and per-client rate limiting middleware
+    crow::App<AccessLogMiddleware, CORSMiddleware, RateLimitMiddleware> app;
+    if (accessLogEnabled) {
+        app.get_middleware<AccessLogMiddleware>().setLog(&accessLog);
+        // Crow's own per-request INFO lines are synchronous; the access log replaces them
+        app.loglevel(crow::LogLevel::Warning);
+    }
+    RateLimitConfig rateLimit = RateLimitConfig::fromEnvironment();
+    app.get_middleware<RateLimitMiddleware>().configure(rateLimit);
+    if (!rateLimit.enabled) {
+        std::cout << "⚠ Rate limiting disabled (VICROW_RATE_LIMIT=off)" << std::endl;
+    }
+
+    // Health check and user routes
+    routes::registerHealthRoutes(app, prisma, userSearch);
+    routes::registerUserRoutes(app, prisma, userEvents, userSearch, emailFilter, userExporter);
+
+    // Post, comment and tag routes
+    routes::registerPostRoutes(app, prisma);
 
     // Configure and start server
-    std::cout << "\nStarting server on http://localhost:8080" << std::endl;
+    std::cout << "\nStarting server on http://localhost:" << port << std::endl;
     std::cout << "Press Ctrl+C to stop\n" << std::endl;
 
-    app.port(8080)
+    app.port(port)
        .multithreaded()
        .run();
 
     // Cleanup
+    cacheWarmer.stop();
+    userEvents.stop();
+    accessLog.stop();
     prisma.disconnect();
     std::cout << "Server stopped." << std::endl;
 
@@ -0,0 +1,305 @@
+#include "middleware/rate_limit.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <random>
+
+namespace vicrow {
+
+namespace {
+
+// Bucket state: high 40 bits are the last refill time in ms since limiter
+// start, low 24 bits the token count in thousandths of a token
+constexpr unsigned TOKEN_BITS = 24;
+constexpr std::uint64_t TOKEN_MASK = (1ull << TOKEN_BITS) - 1;
+constexpr std::uint64_t ONE_TOKEN = 1000;
+
+// Sweep one shard every this many requests
+constexpr std::uint64_t SWEEP_INTERVAL = 4096;
+
+// Entries sampled when a full shard has nothing idle to reclaim
+constexpr std::size_t EVICTION_SAMPLES = 8;
+
+std::uint64_t pack(std::uint64_t timeMs, std::uint64_t tokens) {
+    return (timeMs << TOKEN_BITS) | (tokens & TOKEN_MASK);
+}
+
+std::uint64_t toMilliTokens(double tokens) {
+    auto value = static_cast<std::uint64_t>(std::max(tokens, 0.001) * 1000.0);
+    return std::min<std::uint64_t>(std::max<std::uint64_t>(value, 1), TOKEN_MASK);
+}
+
+std::string trim(const std::string& text) {
+    auto begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    auto end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+
+std::unordered_set<std::string> splitList(const char* value) {
+    std::unordered_set<std::string> items;
+    std::string text(value);
+    std::size_t start = 0;
+    while (start <= text.size()) {
+        std::size_t comma = text.find(',', start);
+        if (comma == std::string::npos) {
+            comma = text.size();
+        }
+        std::string item = trim(text.substr(start, comma - start));
+        if (!item.empty()) {
+            items.insert(item);
+        }
+        start = comma + 1;
+    }
+    return items;
+}
+
+void readPositiveNumber(const char* name, double& target) {
+    const char* value = std::getenv(name);
+    if (value == nullptr) {
+        return;
+    }
+    char* end = nullptr;
+    double parsed = std::strtod(value, &end);
+    if (end == value || *end != '\0' || !(parsed > 0.0)) {
+        std::cerr << "Ignoring " << name << "=" << value << ": expected a positive number" << std::endl;
+        return;
+    }
+    target = parsed;
+}
+
+} // namespace
+
+RateLimitConfig RateLimitConfig::fromEnvironment() {
+    RateLimitConfig config;
+    if (const char* value = std::getenv("VICROW_RATE_LIMIT")) {
+        config.enabled = std::string(value) != "off";
+    }
+    readPositiveNumber("VICROW_RATE_LIMIT_READ_RATE", config.readRate);
+    readPositiveNumber("VICROW_RATE_LIMIT_READ_BURST", config.readBurst);
+    readPositiveNumber("VICROW_RATE_LIMIT_WRITE_RATE", config.writeRate);
+    readPositiveNumber("VICROW_RATE_LIMIT_WRITE_BURST", config.writeBurst);
+    if (const char* value = std::getenv("VICROW_API_KEYS")) {
+        config.apiKeys = splitList(value);
+    }
+    if (const char* value = std::getenv("VICROW_TRUSTED_PROXIES")) {
+        config.trustedProxies = splitList(value);
+    }
+    return config;
+}
+
+RateLimiter::RateLimiter(const RateLimitConfig& config)
+    : config_(config)
+    , epoch_(std::chrono::steady_clock::now())
+{
+    // Rates are stored as milli-tokens per second, capacities as milli-tokens
+    readBudget_ = Budget{toMilliTokens(config_.readRate), std::max(toMilliTokens(config_.readBurst), ONE_TOKEN)};
+    writeBudget_ = Budget{toMilliTokens(config_.writeRate), std::max(toMilliTokens(config_.writeBurst), ONE_TOKEN)};
+
+    std::size_t shardCount = std::max<std::size_t>(config_.shardCount, 1);
+    shards_.reserve(shardCount);
+    for (std::size_t i = 0; i < shardCount; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+std::uint64_t RateLimiter::nowMs() const {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - epoch_).count());
+}
+
+RateLimiter::Shard& RateLimiter::shardFor(const std::string& key) {
+    return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+bool RateLimiter::take(std::atomic<std::uint64_t>& state, const Budget& budget,
+                       std::uint64_t nowMs, std::uint32_t& retryAfterMs) {
+    // Time to refill an empty bucket; longer gaps are clamped to avoid overflow
+    const std::uint64_t fullRefillMs = budget.capacity * 1000 / budget.ratePerSec + 1;
+
+    std::uint64_t current = state.load(std::memory_order_relaxed);
+    for (;;) {
+        std::uint64_t last = current >> TOKEN_BITS;
+        std::uint64_t tokens = current & TOKEN_MASK;
+        std::uint64_t stamp = last;
+
+        if (nowMs > last) {
+            std::uint64_t elapsed = std::min(nowMs - last, fullRefillMs);
+            std::uint64_t refill = elapsed * budget.ratePerSec / 1000;
+            // Keep the old stamp until at least one milli-token accrues, so
+            // slow rates are not lost to rounding
+            if (refill > 0) {
+                tokens = std::min(budget.capacity, tokens + refill);
+                stamp = nowMs;
+            }
+        }
+
+        if (tokens < ONE_TOKEN) {
+            retryAfterMs = static_cast<std::uint32_t>((ONE_TOKEN - tokens) * 1000 / budget.ratePerSec + 1);
+            return false;
+        }
+
+        if (state.compare_exchange_weak(current, pack(stamp, tokens - ONE_TOKEN),
+                                        std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+bool RateLimiter::tryAcquire(const std::string& key, bool write, std::uint32_t& retryAfterMs) {
+    const std::uint64_t now = nowMs();
+    const auto nowSec = static_cast<std::uint32_t>(now / 1000);
+    const Budget& budget = write ? writeBudget_ : readBudget_;
+
+    if (requests_.fetch_add(1, std::memory_order_relaxed) % SWEEP_INTERVAL == SWEEP_INTERVAL - 1) {
+        Shard& shard = *shards_[nextSweep_.fetch_add(1, std::memory_order_relaxed) % shards_.size()];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            sweepShard(shard, nowSec);
+        }
+    }
+
+    Shard& shard = shardFor(key);
+
+    // Fast path: known client, shared lock plus a CAS on the bucket
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.buckets.find(key);
+        if (it != shard.buckets.end()) {
+            Bucket& bucket = *it->second;
+            bucket.lastSeen.store(nowSec, std::memory_order_relaxed);
+            return take(write ? bucket.write : bucket.read, budget, now, retryAfterMs);
+        }
+    }
+
+    // Slow path: first request from this client
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.buckets.find(key);
+    if (it == shard.buckets.end()) {
+        if (shard.buckets.size() >= config_.maxKeysPerShard) {
+            sweepShard(shard, nowSec);
+        }
+        if (shard.buckets.size() >= config_.maxKeysPerShard && !shard.buckets.empty()) {
+            // Nothing idle enough: evict the least recently seen of a small
+            // sample, read from hash buckets starting at a random one so
+            // evictions do not keep hitting the same part of the table
+            thread_local std::minstd_rand rng(std::random_device{}());
+            std::size_t bucketCount = shard.buckets.bucket_count();
+            std::size_t start = rng() % bucketCount;
+            const std::string* victim = nullptr;
+            std::uint32_t victimSeen = 0;
+            std::size_t sampled = 0;
+            for (std::size_t n = 0; n < bucketCount && sampled < EVICTION_SAMPLES; ++n) {
+                std::size_t index = (start + n) % bucketCount;
+                for (auto entry = shard.buckets.begin(index);
+                     entry != shard.buckets.end(index) && sampled < EVICTION_SAMPLES; ++entry, ++sampled) {
+                    std::uint32_t seen = entry->second->lastSeen.load(std::memory_order_relaxed);
+                    if (victim == nullptr || seen < victimSeen) {
+                        victim = &entry->first;
+                        victimSeen = seen;
+                    }
+                }
+            }
+            shard.buckets.erase(std::string(*victim));
+        }
+
+        auto bucket = std::make_unique<Bucket>();
+        bucket->read.store(pack(now, readBudget_.capacity), std::memory_order_relaxed);
+        bucket->write.store(pack(now, writeBudget_.capacity), std::memory_order_relaxed);
+        it = shard.buckets.emplace(key, std::move(bucket)).first;
+    }
+
+    Bucket& bucket = *it->second;
+    bucket.lastSeen.store(nowSec, std::memory_order_relaxed);
+    return take(write ? bucket.write : bucket.read, budget, now, retryAfterMs);
+}
+
+void RateLimiter::sweepShard(Shard& shard, std::uint32_t nowSec) {
+    for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+        std::uint32_t lastSeen = it->second->lastSeen.load(std::memory_order_relaxed);
+        if (lastSeen <= nowSec && nowSec - lastSeen >= config_.idleSeconds) {
+            it = shard.buckets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void RateLimiter::sweep() {
+    const auto nowSec = static_cast<std::uint32_t>(nowMs() / 1000);
+    for (auto& shard : shards_) {
+        std::unique_lock<std::shared_mutex> lock(shard->mutex);
+        sweepShard(*shard, nowSec);
+    }
+}
+
+std::size_t RateLimiter::size() const {
+    std::size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        total += shard->buckets.size();
+    }
+    return total;
+}
+
+std::string RateLimitMiddleware::clientKey(const crow::request& req) const {
+    const RateLimitConfig& config = limiter_->config();
+
+    const std::string& apiKey = req.get_header_value("X-API-Key");
+    if (!apiKey.empty() && config.apiKeys.count(apiKey) > 0) {
+        return "key:" + apiKey;
+    }
+
+    // Only a trusted proxy may speak for the client. Each proxy appends the
+    // address it saw, so walk right to left past our own proxies; everything
+    // further left was written by the client and cannot be trusted.
+    std::string ip = req.remote_ip_address;
+    if (config.trustedProxies.count(ip) > 0) {
+        const std::string& forwarded = req.get_header_value("X-Forwarded-For");
+        std::size_t end = forwarded.size();
+        while (end > 0) {
+            std::size_t comma = forwarded.rfind(',', end - 1);
+            std::size_t begin = comma == std::string::npos ? 0 : comma + 1;
+            std::string hop = trim(forwarded.substr(begin, end - begin));
+            if (!hop.empty()) {
+                ip = hop;
+                if (config.trustedProxies.count(hop) == 0) {
+                    break;
+                }
+            }
+            if (comma == std::string::npos) {
+                break;
+            }
+            end = comma;
+        }
+    }
+
+    return "ip:" + ip;
+}
+
+void RateLimitMiddleware::before_handle(crow::request& req, crow::response& res, context& ctx) {
+    // Preflight requests are answered by CORSMiddleware and cost nothing
+    if (!limiter_->config().enabled || req.method == crow::HTTPMethod::OPTIONS) {
+        return;
+    }
+
+    bool write = req.method != crow::HTTPMethod::GET && req.method != crow::HTTPMethod::HEAD;
+    std::uint32_t retryAfterMs = 0;
+    if (limiter_->tryAcquire(clientKey(req), write, retryAfterMs)) {
+        return;
+    }
+
+    crow::json::wvalue error;
+    error["error"] = "Too many requests";
+    res.code = 429;
+    res.body = error.dump();
+    res.add_header("Content-Type", "application/json");
+    res.add_header("Retry-After", std::to_string((retryAfterMs + 999) / 1000));
+    res.end();
+}
+
+} // namespace vicrow
@@ -0,0 +1,3 @@
+// This file is intentionally left as a placeholder
+// Post routes are implemented as header-only templates
+// See include/routes/posts.hpp
@@ -0,0 +1,227 @@
+#include "services/access_log.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "models/json_string.hpp"
+#include "models/timestamp.hpp"
+
+namespace vicrow {
+
+namespace {
+
+std::size_t roundUpToPowerOfTwo(std::size_t value) {
+    std::size_t power = 1;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+
+// Starts at 1 so a thread's cached generation of 0 never matches a live log
+std::atomic<std::uint64_t> nextGeneration{1};
+
+template<std::size_t N>
+void copyTruncated(char (&dest)[N], std::string_view src) {
+    std::size_t length = std::min(src.size(), N - 1);
+    std::memcpy(dest, src.data(), length);
+    dest[length] = '\0';
+}
+
+} // namespace
+
+AccessLog::AccessLog(const AccessLogConfig& config)
+    : config_(config)
+    , ringCapacity_(roundUpToPowerOfTwo(std::max<std::size_t>(config.ringCapacity, 2)))
+    , generation_(nextGeneration.fetch_add(1, std::memory_order_relaxed))
+{
+}
+
+AccessLog::~AccessLog() {
+    stop();
+}
+
+bool AccessLog::start() {
+    std::lock_guard<std::mutex> lock(runMutex_);
+    if (running_) {
+        return true;
+    }
+
+    if (config_.path == "-") {
+        file_ = stdout;
+    } else {
+        file_ = std::fopen(config_.path.c_str(), "a");
+        if (file_ == nullptr) {
+            return false;
+        }
+        std::fseek(file_, 0, SEEK_END);
+        fileBytes_ = static_cast<std::size_t>(std::max<long>(std::ftell(file_), 0));
+    }
+
+    running_ = true;
+    writer_ = std::thread(&AccessLog::run, this);
+    return true;
+}
+
+void AccessLog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(runMutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+
+    drain();
+    if (file_ != nullptr && file_ != stdout) {
+        std::fclose(file_);
+    }
+    file_ = nullptr;
+}
+
+AccessLog::Ring* AccessLog::threadRing() {
+    // Cache the ring per thread, keyed on the log's generation rather than its
+    // address: a new log allocated where a destroyed one lived must not reuse
+    // the old (freed) ring
+    thread_local std::uint64_t owner = 0;
+    thread_local Ring* ring = nullptr;
+    if (owner != generation_) {
+        auto created = std::make_unique<Ring>(ringCapacity_);
+        ring = created.get();
+        owner = generation_;
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        rings_.push_back(std::move(created));
+    }
+    return ring;
+}
+
+void AccessLog::record(std::string_view method, std::string_view path, int status,
+                       std::uint32_t latencyUs, std::uint32_t upstreamUs, std::uint64_t bytes) {
+    Ring* ring = threadRing();
+
+    // Sample successful requests; always keep errors
+    if (status < 400 && config_.sampleEvery > 1 && ring->sampleCounter++ % config_.sampleEvery != 0) {
+        return;
+    }
+
+    std::uint64_t head = ring->head.load(std::memory_order_relaxed);
+    std::uint64_t tail = ring->tail.load(std::memory_order_acquire);
+    if (head - tail > ring->mask) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    AccessLogRecord& slot = ring->slots[head & ring->mask];
+    slot.timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    slot.latencyUs = latencyUs;
+    slot.upstreamUs = upstreamUs;
+    slot.bytes = bytes;
+    slot.status = static_cast<std::uint16_t>(status);
+    copyTruncated(slot.method, method);
+    copyTruncated(slot.path, path);
+
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void AccessLog::run() {
+    std::unique_lock<std::mutex> lock(runMutex_);
+    while (running_) {
+        wake_.wait_for(lock, config_.flushInterval, [this] { return !running_; });
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void AccessLog::drain() {
+    std::vector<Ring*> rings;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        rings.reserve(rings_.size());
+        for (const auto& ring : rings_) {
+            rings.push_back(ring.get());
+        }
+    }
+
+    std::string batch;
+    char stamp[timestamp::FORMATTED_SIZE];
+    for (Ring* ring : rings) {
+        std::uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        std::uint64_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail < head; ++tail) {
+            const AccessLogRecord& rec = ring->slots[tail & ring->mask];
+            timestamp::format(rec.timestampMs, stamp);
+            batch += "{\"ts\":\"";
+            batch.append(stamp, sizeof(stamp));
+            batch += "\",\"method\":";
+            appendJsonString(batch, rec.method);
+            batch += ",\"path\":";
+            appendJsonString(batch, rec.path);
+            batch += ",\"status\":";
+            batch += std::to_string(rec.status);
+            batch += ",\"latency_us\":";
+            batch += std::to_string(rec.latencyUs);
+            batch += ",\"upstream_us\":";
+            batch += std::to_string(rec.upstreamUs);
+            batch += ",\"bytes\":";
+            batch += std::to_string(rec.bytes);
+            batch += "}\n";
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+
+    std::uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reportedDropped_) {
+        batch += "{\"type\":\"dropped\",\"count\":" + std::to_string(dropped - reportedDropped_)
+               + ",\"total\":" + std::to_string(dropped) + "}\n";
+        reportedDropped_ = dropped;
+    }
+
+    if (!batch.empty()) {
+        write(batch);
+    }
+}
+
+void AccessLog::write(const std::string& batch) {
+    if (file_ == nullptr) {
+        return;
+    }
+    std::fwrite(batch.data(), 1, batch.size(), file_);
+    std::fflush(file_);
+
+    if (file_ == stdout) {
+        return;
+    }
+    fileBytes_ += batch.size();
+    if (fileBytes_ >= config_.maxFileBytes) {
+        rotate();
+    }
+}
+
+void AccessLog::rotate() {
+    std::fclose(file_);
+
+    // access.log.(N-1) -> access.log.N, ..., access.log -> access.log.1
+    for (std::size_t i = config_.maxFiles; i > 1; --i) {
+        std::string from = config_.path + "." + std::to_string(i - 1);
+        std::string to = config_.path + "." + std::to_string(i);
+        std::rename(from.c_str(), to.c_str());
+    }
+    if (config_.maxFiles > 0) {
+        std::rename(config_.path.c_str(), (config_.path + ".1").c_str());
+    } else {
+        std::remove(config_.path.c_str());
+    }
+
+    file_ = std::fopen(config_.path.c_str(), "a");
+    fileBytes_ = 0;
+    if (file_ == nullptr) {
+        std::cerr << "Access log: could not reopen " << config_.path << " after rotation" << std::endl;
+    }
+}
+
+} // namespace vicrow
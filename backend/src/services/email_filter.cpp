@@ -0,0 +1,167 @@
+#include "services/email_filter.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace vicrow {
+
+namespace {
+
+constexpr std::size_t MIN_CAPACITY = 1024;
+
+std::uint64_t mix(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+std::uint64_t hashEmail(std::string_view email) {
+    // FNV-1a, then a splitmix finalizer so low and high bits are both usable
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char c : email) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return mix(hash);
+}
+
+std::size_t roundUpToPowerOfTwo(std::size_t value) {
+    std::size_t power = 1;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+
+} // namespace
+
+void EmailFilter::rebuild(const std::vector<std::string_view>& emails) {
+    std::size_t capacity = std::max(emails.size() * 2, MIN_CAPACITY);
+    std::size_t buckets = roundUpToPowerOfTwo((capacity + SLOTS_PER_BUCKET - 1) / SLOTS_PER_BUCKET);
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    slots_.assign(buckets * SLOTS_PER_BUCKET, 0);
+    bucketMask_ = buckets - 1;
+    count_ = 0;
+    overflowed_ = false;
+    for (auto email : emails) {
+        if (!insertLocked(keyFor(email))) {
+            break;
+        }
+    }
+    ready_ = true;
+}
+
+void EmailFilter::add(std::string_view email) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!ready_ || overflowed_) {
+        return;
+    }
+    insertLocked(keyFor(email));
+}
+
+void EmailFilter::remove(std::string_view email) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!ready_ || overflowed_) {
+        return;
+    }
+    Key key = keyFor(email);
+    if (removeFrom(key.bucket, key.fingerprint)
+        || removeFrom(altBucket(key.bucket, key.fingerprint), key.fingerprint)) {
+        --count_;
+    }
+}
+
+bool EmailFilter::mightContain(std::string_view email) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (!ready_ || overflowed_) {
+        return true;
+    }
+    Key key = keyFor(email);
+    return bucketContains(key.bucket, key.fingerprint)
+        || bucketContains(altBucket(key.bucket, key.fingerprint), key.fingerprint);
+}
+
+bool EmailFilter::isReady() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return ready_ && !overflowed_;
+}
+
+std::size_t EmailFilter::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return count_;
+}
+
+EmailFilter::Key EmailFilter::keyFor(std::string_view email) const {
+    std::uint64_t hash = hashEmail(email);
+    auto fingerprint = static_cast<std::uint16_t>(hash >> 48);
+    if (fingerprint == 0) {
+        fingerprint = 1;
+    }
+    return {static_cast<std::size_t>(hash) & bucketMask_, fingerprint};
+}
+
+std::size_t EmailFilter::altBucket(std::size_t bucket, std::uint16_t fingerprint) const {
+    // XOR with the fingerprint's hash, so the alternate of the alternate is the original
+    return (bucket ^ static_cast<std::size_t>(mix(fingerprint))) & bucketMask_;
+}
+
+bool EmailFilter::bucketContains(std::size_t bucket, std::uint16_t fingerprint) const {
+    const std::uint16_t* slot = &slots_[bucket * SLOTS_PER_BUCKET];
+    for (std::size_t i = 0; i < SLOTS_PER_BUCKET; ++i) {
+        if (slot[i] == fingerprint) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EmailFilter::removeFrom(std::size_t bucket, std::uint16_t fingerprint) {
+    std::uint16_t* slot = &slots_[bucket * SLOTS_PER_BUCKET];
+    for (std::size_t i = 0; i < SLOTS_PER_BUCKET; ++i) {
+        if (slot[i] == fingerprint) {
+            slot[i] = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EmailFilter::insertLocked(Key key) {
+    std::size_t buckets[2] = {key.bucket, altBucket(key.bucket, key.fingerprint)};
+    for (std::size_t bucket : buckets) {
+        std::uint16_t* slot = &slots_[bucket * SLOTS_PER_BUCKET];
+        for (std::size_t i = 0; i < SLOTS_PER_BUCKET; ++i) {
+            if (slot[i] == 0) {
+                slot[i] = key.fingerprint;
+                ++count_;
+                return true;
+            }
+        }
+    }
+
+    // Both buckets full: evict a resident fingerprint to its alternate bucket
+    std::size_t bucket = buckets[key.fingerprint & 1];
+    std::uint16_t fingerprint = key.fingerprint;
+    for (int kick = 0; kick < MAX_KICKS; ++kick) {
+        std::uint16_t& victim = slots_[bucket * SLOTS_PER_BUCKET
+                                       + static_cast<std::size_t>(mix(fingerprint + kick)) % SLOTS_PER_BUCKET];
+        std::swap(fingerprint, victim);
+        bucket = altBucket(bucket, fingerprint);
+
+        std::uint16_t* slot = &slots_[bucket * SLOTS_PER_BUCKET];
+        for (std::size_t i = 0; i < SLOTS_PER_BUCKET; ++i) {
+            if (slot[i] == 0) {
+                slot[i] = fingerprint;
+                ++count_;
+                return true;
+            }
+        }
+    }
+
+    // A fingerprint is now homeless, so misses can no longer be trusted
+    overflowed_ = true;
+    return false;
+}
+
+} // namespace vicrow
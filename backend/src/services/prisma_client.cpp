@@ -1,14 +1,173 @@
 #include "services/prisma_client.hpp"
+#include "models/url_encoding.hpp"
 #include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 #include <memory>
 #include <stdexcept>
 #include <cstdio>
+#include <cstdlib>
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
 
 namespace vicrow {
 
+namespace {
+
+// Time spent in executeQuery by the current thread; Crow runs a request's
+// middleware and handler on one thread, so this is per request
+thread_local std::uint64_t upstreamMicros = 0;
+
+/**
+ * @brief SAX handler that appends a JSON array of user rows to a UserList
+ *
+ * Only the top-level array and the fields of each row object are read;
+ * nested values (such as included relations) are skipped.
+ */
+class UserListReader : public json::json_sax_t {
+public:
+    explicit UserListReader(UserList& users) : users_(users) {}
+
+    bool complete() const { return sawArray_ && depth_ == 0; }
+    const std::string& error() const { return error_; }
+
+    bool null() override {
+        if (inRow() && field_ == Field::Name) {
+            name_.reset();
+        }
+        return true;
+    }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t value) override { return number(value); }
+    bool number_unsigned(number_unsigned_t value) override {
+        return number(static_cast<number_integer_t>(value));
+    }
+    bool number_float(number_float_t, const string_t&) override { return true; }
+    bool binary(binary_t&) override { return true; }
+
+    bool string(string_t& value) override {
+        if (!inRow()) {
+            return true;
+        }
+        switch (field_) {
+            case Field::Email: email_ = std::move(value); break;
+            case Field::Name: name_ = std::move(value); break;
+            case Field::CreatedAt: createdAt_ = timestamp::parse(value); break;
+            case Field::UpdatedAt: updatedAt_ = timestamp::parse(value); break;
+            default: break;
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        if (depth_ == 0) {
+            return fail("expected an array of users");
+        }
+        if (++depth_ == 2) {
+            id_ = 0;
+            email_.clear();
+            name_.reset();
+            createdAt_.reset();
+            updatedAt_.reset();
+        }
+        field_ = Field::Other;
+        return true;
+    }
+
+    bool key(string_t& name) override {
+        if (depth_ != 2) {
+            return true;
+        }
+        if (name == "id") field_ = Field::Id;
+        else if (name == "email") field_ = Field::Email;
+        else if (name == "name") field_ = Field::Name;
+        else if (name == "createdAt") field_ = Field::CreatedAt;
+        else if (name == "updatedAt") field_ = Field::UpdatedAt;
+        else field_ = Field::Other;
+        return true;
+    }
+
+    bool end_object() override {
+        if (depth_-- == 2) {
+            users_.append(id_, email_,
+                          name_.has_value() ? std::optional<std::string_view>(name_.value()) : std::nullopt,
+                          createdAt_, updatedAt_);
+        }
+        field_ = Field::Other;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        if (depth_ == 0) {
+            if (sawArray_) {
+                return fail("expected an array of users");
+            }
+            sawArray_ = true;
+        }
+        ++depth_;
+        field_ = Field::Other;
+        return true;
+    }
+
+    bool end_array() override {
+        --depth_;
+        field_ = Field::Other;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e) override {
+        return fail(e.what());
+    }
+
+private:
+    enum class Field { Other, Id, Email, Name, CreatedAt, UpdatedAt };
+
+    // Scalars directly inside a row object; anything deeper is a relation
+    bool inRow() const { return depth_ == 2; }
+
+    bool number(number_integer_t value) {
+        if (inRow() && field_ == Field::Id) {
+            id_ = static_cast<int>(value);
+        }
+        return true;
+    }
+
+    bool fail(std::string message) {
+        error_ = std::move(message);
+        return false;
+    }
+
+    UserList& users_;
+    std::size_t depth_ = 0;
+    bool sawArray_ = false;
+    Field field_ = Field::Other;
+    int id_ = 0;
+    std::string email_;
+    std::optional<std::string> name_;
+    std::optional<std::int64_t> createdAt_;
+    std::optional<std::int64_t> updatedAt_;
+    std::string error_;
+};
+
+} // namespace
+
+std::uint64_t PrismaClient::threadUpstreamMicros() {
+    return upstreamMicros;
+}
+
+void PrismaClient::resetThreadUpstreamMicros() {
+    upstreamMicros = 0;
+}
+
 PrismaClient::PrismaClient() 
     : serviceUrl_("http://localhost:3001")
     , connected_(false) 
@@ -39,64 +198,140 @@ void PrismaClient::disconnect() {
     connected_ = false;
 }
 
-std::string PrismaClient::executeCommand(const std::string& command) {
-    std::array<char, 128> buffer;
+std::string PrismaClient::executeCommand(const std::string& command, const std::string& input) {
+    // stdin is a socket rather than a pipe so a child that exits early makes
+    // send() fail with EPIPE instead of raising SIGPIPE in this process.
+    // Both ends are close-on-exec so concurrent commands do not inherit them.
+    int in[2];
+    int out[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, in) != 0) {
+        throw std::runtime_error("Could not start curl: " + std::string(std::strerror(errno)));
+    }
+    if (::pipe2(out, O_CLOEXEC) != 0) {
+        int error = errno;
+        ::close(in[0]);
+        ::close(in[1]);
+        throw std::runtime_error("Could not start curl: " + std::string(std::strerror(error)));
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, in[1], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+    const char* argv[] = {"sh", "-c", command.c_str(), nullptr};
+    pid_t pid = 0;
+    int spawnError = posix_spawn(&pid, "/bin/sh", &actions, nullptr, const_cast<char* const*>(argv), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(in[1]);
+    ::close(out[1]);
+    if (spawnError != 0) {
+        ::close(in[0]);
+        ::close(out[0]);
+        throw std::runtime_error("Could not start curl: " + std::string(std::strerror(spawnError)));
+    }
+
+    // curl reads all of stdin before sending, so writing first cannot deadlock
+    std::size_t sent = 0;
+    while (sent < input.size()) {
+        ssize_t n = ::send(in[0], input.data() + sent, input.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+    ::close(in[0]);
+
     std::string result;
-    std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(command.c_str(), "r"), pclose);
-    
-    if (!pipe) {
-        throw std::runtime_error("popen() failed!");
+    std::array<char, 16384> buffer;
+    for (;;) {
+        ssize_t n = ::read(out[0], buffer.data(), buffer.size());
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        result.append(buffer.data(), static_cast<std::size_t>(n));
     }
-    
-    while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-        result += buffer.data();
+    ::close(out[0]);
+
+    int waitStatus = 0;
+    while (::waitpid(pid, &waitStatus, 0) < 0 && errno == EINTR) {
     }
-    
     return result;
 }
 
 json PrismaClient::executeQuery(const std::string& endpoint, const std::string& method, const json& body) {
+    int status = 0;
+    std::string result = executeRaw(endpoint, method, body, status);
+    try {
+        return json::parse(result);
+    } catch (const json::parse_error& e) {
+        throw PrismaError(status, "Failed to parse Prisma response: " + std::string(e.what()));
+    }
+}
+
+std::string PrismaClient::executeRaw(const std::string& endpoint, const std::string& method, const json& body,
+                                     int& status) {
     std::stringstream ss;
     ss << "curl -s -X " << method << " ";
     ss << "-H 'Content-Type: application/json' ";
     
+    // The body goes to curl on stdin, so its size is not bounded by the
+    // argument list limit and it needs no shell quoting
+    std::string input;
     if (!body.empty()) {
-        // Escape the JSON for shell
-        std::string jsonStr = body.dump();
-        // Replace single quotes with escaped version
-        size_t pos = 0;
-        while ((pos = jsonStr.find("'", pos)) != std::string::npos) {
-            jsonStr.replace(pos, 1, "'\\''");
-            pos += 4;
-        }
-        ss << "-d '" << jsonStr << "' ";
+        input = body.dump();
+        ss << "--data-binary @- ";
     }
     
+    // Append the HTTP status on its own line so errors keep their code
+    ss << "-w '\\n%{http_code}' ";
     ss << serviceUrl_ << endpoint;
     
-    std::string result = executeCommand(ss.str());
+    auto started = std::chrono::steady_clock::now();
+    std::string result = executeCommand(ss.str(), input);
+    upstreamMicros += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count());
     
+    status = 0;
+    auto statusLine = result.rfind('\n');
+    if (statusLine != std::string::npos) {
+        status = std::atoi(result.c_str() + statusLine + 1);
+        result.erase(statusLine);
+    }
+    if (status == 0) {
+        throw std::runtime_error("Could not reach Prisma service");
+    }
     if (result.empty()) {
-        throw std::runtime_error("Empty response from Prisma service");
+        throw PrismaError(status, "Empty response from Prisma service");
     }
     
-    try {
-        return json::parse(result);
-    } catch (const json::parse_error& e) {
-        throw std::runtime_error("Failed to parse Prisma response: " + std::string(e.what()));
+    if (status >= 400) {
+        std::string message = "Prisma service returned HTTP " + std::to_string(status);
+        json parsed = json::parse(result, nullptr, false);
+        if (parsed.is_object() && parsed.contains("error") && parsed["error"].is_string()) {
+            message = parsed["error"].get<std::string>();
+        }
+        throw PrismaError(status, message);
     }
+    return result;
 }
 
-std::vector<User> PrismaClient::findManyUsers() {
-    auto result = executeQuery("/api/users", "GET");
-    
-    std::vector<User> users;
-    if (result.is_array()) {
-        for (const auto& item : result) {
-            users.push_back(User::from_json(item));
-        }
+UserList PrismaClient::findManyUsers() {
+    int status = 0;
+    std::string result = executeRaw("/api/users", "GET", json::object(), status);
+
+    // Rows go from the response text straight into the pool; no JSON tree is built
+    UserList users;
+    users.reserve(result.size() / 128, result.size() / 3);
+    UserListReader reader(users);
+    if (!json::sax_parse(result, &reader) || !reader.complete()) {
+        throw PrismaError(status, "Failed to parse Prisma response: " + reader.error());
     }
-    
     return users;
 }
 
@@ -113,14 +348,16 @@ std::optional<User> PrismaClient::findUserById(int id) {
 }
 
 std::optional<User> PrismaClient::findUserByEmail(const std::string& email) {
+    // Only a real 404 means "no such user"; callers treat that as the email
+    // being free, so transport and server errors must not look the same
     try {
-        auto result = executeQuery("/api/users/email/" + email, "GET");
-        if (result.contains("error")) {
+        auto result = executeQuery("/api/users/email/" + encodePathSegment(email), "GET");
+        return User::from_json(result);
+    } catch (const PrismaError& e) {
+        if (e.status() == 404) {
             return std::nullopt;
         }
-        return User::from_json(result);
-    } catch (...) {
-        return std::nullopt;
+        throw;
     }
 }
 
@@ -169,4 +406,168 @@ bool PrismaClient::deleteUser(int id) {
     }
 }
 
+std::vector<BatchCreateResult> PrismaClient::createManyUsers(const std::vector<CreateUserDto>& users) {
+    json rows = json::array();
+    for (const auto& dto : users) {
+        json row;
+        row["email"] = dto.email;
+        row["name"] = dto.name.has_value() ? json(dto.name.value()) : json(nullptr);
+        rows.push_back(std::move(row));
+    }
+    json body;
+    body["users"] = std::move(rows);
+
+    auto result = executeQuery("/api/users/batch", "POST", body);
+    if (!result.contains("results") || !result["results"].is_array()) {
+        throw std::runtime_error(result.value("error", "Invalid batch response from Prisma service"));
+    }
+
+    const auto& items = result["results"];
+    if (items.size() != users.size()) {
+        throw std::runtime_error("Batch response does not match the request");
+    }
+
+    std::vector<BatchCreateResult> results;
+    results.reserve(items.size());
+    for (const auto& item : items) {
+        BatchCreateResult entry;
+        if (item.contains("user") && item["user"].is_object()) {
+            entry.user = User::from_json(item["user"]);
+        } else {
+            entry.error = item.value("error", "Failed to create user");
+        }
+        results.push_back(std::move(entry));
+    }
+    return results;
+}
+
+std::uint64_t PrismaClient::exportUsers(const std::string& path) {
+    std::string quotedPath = path;
+    std::size_t pos = 0;
+    while ((pos = quotedPath.find("'", pos)) != std::string::npos) {
+        quotedPath.replace(pos, 1, "'\\''");
+        pos += 4;
+    }
+
+    std::stringstream ss;
+    ss << "curl -s -S --fail -o '" << quotedPath << "' -w '%{size_download}' ";
+    ss << serviceUrl_ << "/api/users/export 2>&1";
+
+    auto started = std::chrono::steady_clock::now();
+    std::array<char, 128> buffer;
+    std::string output;
+    FILE* pipe = popen(ss.str().c_str(), "r");
+    if (!pipe) {
+        throw std::runtime_error("popen() failed!");
+    }
+    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
+        output += buffer.data();
+    }
+    int status = pclose(pipe);
+    upstreamMicros += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count());
+
+    // A non-zero exit also catches streams the service aborted part-way
+    if (status != 0) {
+        // curl's own message comes first; the rest is the -w byte count
+        std::string message = output.substr(0, output.find('\n'));
+        throw std::runtime_error("User export failed: " + (message.empty() ? "curl exited with an error" : message));
+    }
+    return std::strtoull(output.c_str(), nullptr, 10);
+}
+
+std::vector<Post> PrismaClient::findManyPosts(const PostQuery& query) {
+    json body;
+    body["select"] = query.toSelect();
+
+    auto result = executeQuery("/api/posts/query", "POST", body);
+    if (!result.is_array()) {
+        throw std::runtime_error("Expected an array of posts from Prisma service");
+    }
+
+    std::vector<Post> posts;
+    posts.reserve(result.size());
+    for (const auto& item : result) {
+        posts.push_back(Post::from_json(item));
+    }
+
+    return posts;
+}
+
+std::optional<Post> PrismaClient::findPostById(int id, const PostQuery& query) {
+    json body;
+    body["select"] = query.toSelect();
+
+    // As with findUserByEmail, only a real 404 means the post does not exist
+    try {
+        auto result = executeQuery("/api/posts/" + std::to_string(id) + "/query", "POST", body);
+        return Post::from_json(result);
+    } catch (const PrismaError& e) {
+        if (e.status() == 404) {
+            return std::nullopt;
+        }
+        throw;
+    }
+}
+
+Post PrismaClient::createPost(const CreatePostDto& dto) {
+    json body;
+    body["title"] = dto.title;
+    if (dto.content.has_value()) {
+        body["content"] = dto.content.value();
+    }
+    body["published"] = dto.published;
+    body["authorId"] = dto.authorId;
+    if (!dto.tags.empty()) {
+        body["tags"] = dto.tags;
+    }
+
+    auto result = executeQuery("/api/posts", "POST", body);
+
+    if (result.contains("error")) {
+        throw std::runtime_error(result["error"].get<std::string>());
+    }
+
+    return Post::from_json(result);
+}
+
+std::vector<Comment> PrismaClient::findCommentsByPost(int postId) {
+    auto result = executeQuery("/api/posts/" + std::to_string(postId) + "/comments", "GET");
+
+    std::vector<Comment> comments;
+    if (result.is_array()) {
+        for (const auto& item : result) {
+            comments.push_back(Comment::from_json(item));
+        }
+    }
+
+    return comments;
+}
+
+Comment PrismaClient::createComment(int postId, const CreateCommentDto& dto) {
+    json body;
+    body["content"] = dto.content;
+
+    auto result = executeQuery("/api/posts/" + std::to_string(postId) + "/comments", "POST", body);
+
+    if (result.contains("error")) {
+        throw std::runtime_error(result["error"].get<std::string>());
+    }
+
+    return Comment::from_json(result);
+}
+
+std::vector<Tag> PrismaClient::findManyTags() {
+    auto result = executeQuery("/api/tags", "GET");
+
+    std::vector<Tag> tags;
+    if (result.is_array()) {
+        for (const auto& item : result) {
+            tags.push_back(Tag::from_json(item));
+        }
+    }
+
+    return tags;
+}
+
 } // namespace vicrow
@@ -0,0 +1,77 @@
+#include "services/user_cache_warmer.hpp"
+#include <iostream>
+
+namespace vicrow {
+
+UserCacheWarmer::UserCacheWarmer(PrismaClient& prisma, UserSearchIndex& search,
+                                 std::chrono::seconds retryInterval)
+    : prisma_(prisma)
+    , search_(search)
+    , retryInterval_(retryInterval)
+{
+}
+
+UserCacheWarmer::~UserCacheWarmer() {
+    stop();
+}
+
+bool UserCacheWarmer::start() {
+    if (attempt()) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+        running_ = true;
+        worker_ = std::thread(&UserCacheWarmer::run, this);
+    }
+    return false;
+}
+
+void UserCacheWarmer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool UserCacheWarmer::attempt() {
+    if (!prisma_.isConnected() && !prisma_.connect()) {
+        return false;
+    }
+    try {
+        auto users = prisma_.findManyUsers();
+        search_.rebuild(users);
+        warm_.store(true, std::memory_order_release);
+        std::cout << "✓ Indexed " << search_.size() << " users for search and email lookup" << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cout << "⚠ Could not warm user caches: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void UserCacheWarmer::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        wake_.wait_for(lock, retryInterval_, [this] { return !running_; });
+        if (!running_) {
+            return;
+        }
+        lock.unlock();
+        bool done = attempt();
+        lock.lock();
+        if (done) {
+            return;
+        }
+    }
+}
+
+} // namespace vicrow
@@ -0,0 +1,265 @@
+#include "services/user_events.hpp"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace vicrow {
+
+UserEventHub::UserEventHub(std::size_t historySize, std::size_t maxLag, std::size_t maxBatch,
+                           std::chrono::milliseconds ackTimeout)
+    : historySize_(historySize)
+    , maxLag_(std::max<std::size_t>(maxLag, 1))
+    , maxBatch_(maxBatch)
+    , ackTimeout_(ackTimeout)
+{
+}
+
+UserEventHub::~UserEventHub() {
+    stop();
+}
+
+void UserEventHub::start() {
+    std::lock_guard<std::mutex> lock(historyMutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    dispatcher_ = std::thread(&UserEventHub::run, this);
+}
+
+void UserEventHub::stop() {
+    {
+        std::lock_guard<std::mutex> lock(historyMutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (dispatcher_.joinable()) {
+        dispatcher_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    subscribers_.clear();
+}
+
+void UserEventHub::publishCreated(const User& user) {
+    json data;
+    data["user"] = user.to_json();
+    publish("create", std::move(data));
+}
+
+void UserEventHub::publishUpdated(const User& user) {
+    json data;
+    data["user"] = user.to_json();
+    publish("update", std::move(data));
+}
+
+void UserEventHub::publishDeleted(int id) {
+    json data;
+    data["id"] = id;
+    publish("delete", std::move(data));
+}
+
+void UserEventHub::publish(const char* type, json data) {
+    // Serialize outside the lock; only the sequence prefix is added inside
+    std::string body = data.dump();
+    body = body.substr(1, body.size() - 2);
+
+    {
+        std::lock_guard<std::mutex> lock(historyMutex_);
+        std::uint64_t seq = ++lastSeq_;
+        auto payload = std::make_shared<const std::string>(
+            "{\"seq\":" + std::to_string(seq) + ",\"type\":\"" + type + "\"," + body + "}");
+        history_.push_back(Event{seq, std::move(payload)});
+        if (history_.size() > historySize_) {
+            history_.pop_front();
+        }
+        pending_ = true;
+    }
+    wake_.notify_one();
+}
+
+void UserEventHub::subscribe(std::uintptr_t key, std::optional<std::uint64_t> since,
+                             SendFn send, CloseFn close) {
+    std::uint64_t head = lastSequence();
+    std::uint64_t nextSeq = since.has_value() ? since.value() + 1 : head + 1;
+
+    send("{\"type\":\"hello\",\"seq\":" + std::to_string(head) + "}");
+    if (nextSeq > head + 1) {
+        // Resuming from the future: sequences restarted (backend restart), so refetch
+        send("{\"type\":\"reset\",\"seq\":" + std::to_string(head) + "}");
+        nextSeq = head + 1;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(subscribersMutex_);
+        subscribers_[key] = Subscriber{nextSeq, nextSeq - 1, {}, std::move(send), std::move(close)};
+    }
+
+    if (nextSeq <= head) {
+        {
+            std::lock_guard<std::mutex> lock(historyMutex_);
+            pending_ = true;
+        }
+        wake_.notify_one();
+    }
+}
+
+void UserEventHub::ack(std::uintptr_t key, std::uint64_t seq) {
+    {
+        std::lock_guard<std::mutex> lock(subscribersMutex_);
+        auto it = subscribers_.find(key);
+        if (it == subscribers_.end()) {
+            return;
+        }
+        Subscriber& sub = it->second;
+        seq = std::min(seq, sub.nextSeq - 1);
+        if (seq <= sub.acked) {
+            return;
+        }
+        sub.acked = seq;
+    }
+    {
+        std::lock_guard<std::mutex> lock(historyMutex_);
+        pending_ = true;
+    }
+    wake_.notify_one();
+}
+
+void UserEventHub::unsubscribe(std::uintptr_t key) {
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    subscribers_.erase(key);
+}
+
+std::uint64_t UserEventHub::lastSequence() const {
+    std::lock_guard<std::mutex> lock(historyMutex_);
+    return lastSeq_;
+}
+
+std::size_t UserEventHub::subscriberCount() const {
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    return subscribers_.size();
+}
+
+void UserEventHub::run() {
+    // While any subscriber is paused on acks, wake periodically to enforce ackTimeout
+    bool anyPaused = false;
+    auto recheck = std::max<std::chrono::milliseconds>(ackTimeout_ / 4, std::chrono::milliseconds(10));
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(historyMutex_);
+            auto ready = [this] { return pending_ || !running_; };
+            if (anyPaused) {
+                wake_.wait_for(lock, recheck, ready);
+            } else {
+                wake_.wait(lock, ready);
+            }
+            if (!running_) {
+                return;
+            }
+            pending_ = false;
+        }
+
+        // Oldest cursor decides how much history this round needs
+        std::uint64_t minNext = std::numeric_limits<std::uint64_t>::max();
+        {
+            std::lock_guard<std::mutex> lock(subscribersMutex_);
+            for (const auto& entry : subscribers_) {
+                minNext = std::min(minNext, entry.second.nextSeq);
+            }
+        }
+        anyPaused = false;
+        if (minNext == std::numeric_limits<std::uint64_t>::max()) {
+            continue;
+        }
+
+        // Copy only the needed tail of the ring; payloads are shared, not copied
+        std::vector<Event> events;
+        std::uint64_t head;
+        std::uint64_t oldest;
+        std::uint64_t start;
+        {
+            std::lock_guard<std::mutex> lock(historyMutex_);
+            head = lastSeq_;
+            oldest = history_.empty() ? head + 1 : history_.front().seq;
+            start = std::max(minNext, oldest);
+            if (start <= head) {
+                events.assign(history_.begin() + static_cast<std::ptrdiff_t>(start - oldest),
+                              history_.end());
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        bool more = false;
+        {
+            std::lock_guard<std::mutex> lock(subscribersMutex_);
+            for (auto it = subscribers_.begin(); it != subscribers_.end();) {
+                Subscriber& sub = it->second;
+
+                if (sub.nextSeq > head) {
+                    sub.pausedSince = {};
+                    ++it;
+                    continue;
+                }
+
+                std::uint64_t inFlight = sub.nextSeq - 1 - sub.acked;
+                if (sub.nextSeq < oldest) {
+                    if (inFlight > 0) {
+                        // Stalled so long that its next event left history
+                        sub.close("slow consumer");
+                        it = subscribers_.erase(it);
+                        continue;
+                    }
+                    // Resume point is gone: client must refetch
+                    sub.send("{\"type\":\"reset\",\"seq\":" + std::to_string(head) + "}");
+                    sub.nextSeq = head + 1;
+                    sub.acked = head;
+                    ++it;
+                    continue;
+                }
+                if (inFlight >= maxLag_) {
+                    // Window full: stop writing to the socket until the client acks
+                    if (sub.pausedSince == std::chrono::steady_clock::time_point{}) {
+                        sub.pausedSince = now;
+                    } else if (now - sub.pausedSince > ackTimeout_) {
+                        sub.close("slow consumer");
+                        it = subscribers_.erase(it);
+                        continue;
+                    }
+                    anyPaused = true;
+                    ++it;
+                    continue;
+                }
+                sub.pausedSince = {};
+                if (sub.nextSeq < start) {
+                    // Subscribed after this round's snapshot; pick it up next round
+                    more = true;
+                    ++it;
+                    continue;
+                }
+
+                std::size_t window = static_cast<std::size_t>(maxLag_ - inFlight);
+                std::size_t index = static_cast<std::size_t>(sub.nextSeq - start);
+                std::size_t end = std::min(events.size(), index + std::min(maxBatch_, window));
+                for (std::size_t i = index; i < end; ++i) {
+                    sub.send(*events[i].payload);
+                }
+                sub.nextSeq = start + end;
+                if (sub.nextSeq <= head) {
+                    more = true;
+                }
+                ++it;
+            }
+        }
+
+        if (more) {
+            std::lock_guard<std::mutex> lock(historyMutex_);
+            pending_ = true;
+        }
+    }
+}
+
+} // namespace vicrow
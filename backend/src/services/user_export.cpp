@@ -0,0 +1,117 @@
+#include "services/user_export.hpp"
+#include <cerrno>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+namespace vicrow {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* SPOOL_PREFIX = "users-";
+constexpr const char* SPOOL_SUFFIX = ".ndjson";
+
+bool isSpoolFile(const fs::path& path) {
+    std::string name = path.filename().string();
+    return name.rfind(SPOOL_PREFIX, 0) == 0 && path.extension() == SPOOL_SUFFIX;
+}
+
+} // namespace
+
+UserExporter::UserExporter(PrismaClient& prisma, std::string parent, std::chrono::seconds retention,
+                           std::size_t maxSpoolFiles)
+    : prisma_(prisma)
+    , retention_(retention)
+    , maxSpoolFiles_(maxSpoolFiles)
+{
+    if (parent.empty()) {
+        std::error_code ec;
+        fs::path temp = fs::temp_directory_path(ec);
+        parent = (ec ? fs::path("/tmp") : temp).string();
+    }
+
+    // mkdtemp creates a fresh 0700 directory, so nothing in it is shared
+    std::string pattern = (fs::path(parent) / "vicrow-export-XXXXXX").string();
+    std::vector<char> buffer(pattern.begin(), pattern.end());
+    buffer.push_back('\0');
+    if (::mkdtemp(buffer.data()) != nullptr) {
+        directory_ = buffer.data();
+    } else {
+        error_ = "Could not create export directory in " + parent + ": " + std::strerror(errno);
+    }
+}
+
+UserExporter::~UserExporter() {
+    if (!directory_.empty()) {
+        std::error_code ec;
+        fs::remove_all(directory_, ec);
+    }
+}
+
+std::string UserExporter::exportToFile() {
+    if (directory_.empty()) {
+        throw std::runtime_error(error_);
+    }
+
+    std::string path = (fs::path(directory_)
+        / (SPOOL_PREFIX + std::to_string(counter_.fetch_add(1)) + SPOOL_SUFFIX)).string();
+    {
+        // The empty file claims its slot before the lock is released
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::chrono::seconds nextExpiry(0);
+        if (prune(nextExpiry) >= maxSpoolFiles_) {
+            throw ExportBusyError(nextExpiry);
+        }
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("Could not create export file " + path + ": " + std::strerror(errno));
+        }
+        ::close(fd);
+    }
+
+    try {
+        prisma_.exportUsers(path);
+    } catch (...) {
+        std::error_code ec;
+        fs::remove(path, ec);
+        throw;
+    }
+    return path;
+}
+
+std::size_t UserExporter::prune(std::chrono::seconds& nextExpiry) {
+    auto now = fs::file_time_type::clock::now();
+    auto cutoff = now - retention_;
+    auto oldest = now;
+    std::size_t remaining = 0;
+    std::error_code ec;
+    for (fs::directory_iterator it(directory_, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!isSpoolFile(it->path())) {
+            continue;
+        }
+        std::error_code entryEc;
+        auto written = fs::last_write_time(it->path(), entryEc);
+        if (entryEc) {
+            continue;
+        }
+        if (written < cutoff) {
+            fs::remove(it->path(), entryEc);
+            continue;
+        }
+        // A spool still being written counts too; its expiry moves with each write
+        ++remaining;
+        oldest = std::min(oldest, written);
+    }
+    auto wait = std::chrono::ceil<std::chrono::seconds>(oldest - cutoff);
+    nextExpiry = std::max(wait, std::chrono::seconds(1));
+    return remaining;
+}
+
+} // namespace vicrow
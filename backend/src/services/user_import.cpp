@@ -0,0 +1,169 @@
+#include "services/user_import.hpp"
+#include <exception>
+#include <unordered_set>
+
+namespace vicrow {
+
+namespace {
+
+/**
+ * @brief Rows waiting to be sent upstream, with their source line numbers
+ */
+struct Batch {
+    std::vector<CreateUserDto> rows;
+    std::vector<std::size_t> lineNumbers;
+    std::unordered_set<std::string> emails;
+    std::size_t bytes = 0;
+
+    void clear() {
+        rows.clear();
+        lineNumbers.clear();
+        emails.clear();
+        bytes = 0;
+    }
+};
+
+/**
+ * @brief Bytes a row adds to the batch body, as createManyUsers serializes it
+ */
+std::size_t serializedSize(const CreateUserDto& dto) {
+    json row;
+    row["email"] = dto.email;
+    row["name"] = dto.name.has_value() ? json(dto.name.value()) : json(nullptr);
+    return row.dump().size() + 1;  // separating comma
+}
+
+void addError(ImportReport& report, std::size_t maxErrors, std::size_t line, std::string error) {
+    ++report.failed;
+    if (report.errors.size() < maxErrors) {
+        report.errors.push_back({line, std::move(error)});
+    } else {
+        report.errorsTruncated = true;
+    }
+}
+
+/**
+ * @brief Validate one line into a DTO, or return the reason it is invalid
+ */
+std::optional<std::string> parseLine(std::string_view line, CreateUserDto& dto) {
+    json j = json::parse(line.begin(), line.end(), nullptr, false);
+    if (j.is_discarded()) {
+        return std::string("Invalid JSON");
+    }
+    if (!j.is_object()) {
+        return std::string("Expected a JSON object");
+    }
+
+    auto email = j.find("email");
+    if (email == j.end() || !email->is_string() || email->get_ref<const std::string&>().empty()) {
+        return std::string("Email is required");
+    }
+    dto.email = email->get<std::string>();
+
+    dto.name.reset();
+    auto name = j.find("name");
+    if (name != j.end() && !name->is_null()) {
+        if (!name->is_string()) {
+            return std::string("Name must be a string or null");
+        }
+        dto.name = name->get<std::string>();
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+UserImporter::UserImporter(PrismaClient& prisma, const UserImportConfig& config)
+    : prisma_(prisma)
+    , config_(config)
+{
+}
+
+ImportReport UserImporter::run(std::string_view ndjson, const CreatedFn& onCreated) const {
+    ImportReport report;
+    Batch batch;
+    batch.rows.reserve(config_.batchRows);
+    batch.lineNumbers.reserve(config_.batchRows);
+
+    auto flush = [&]() -> bool {
+        if (batch.rows.empty()) {
+            return true;
+        }
+        try {
+            auto results = prisma_.createManyUsers(batch.rows);
+            for (std::size_t i = 0; i < results.size(); ++i) {
+                if (results[i].user.has_value()) {
+                    ++report.created;
+                    onCreated(*results[i].user);
+                } else {
+                    addError(report, config_.maxErrors, batch.lineNumbers[i], results[i].error);
+                }
+            }
+        } catch (const std::exception& e) {
+            for (auto line : batch.lineNumbers) {
+                addError(report, config_.maxErrors, line, e.what());
+            }
+            report.aborted = e.what();
+        }
+        batch.clear();
+        return !report.aborted.has_value();
+    };
+
+    std::size_t lineNumber = 0;
+    std::size_t start = 0;
+    CreateUserDto dto;
+    while (start < ndjson.size()) {
+        std::size_t end = ndjson.find('\n', start);
+        if (end == std::string_view::npos) {
+            end = ndjson.size();
+        }
+        std::string_view line = ndjson.substr(start, end - start);
+        start = end + 1;
+        ++lineNumber;
+
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.find_first_not_of(" \t") == std::string_view::npos) {
+            continue;
+        }
+        ++report.lines;
+
+        if (auto error = parseLine(line, dto)) {
+            addError(report, config_.maxErrors, lineNumber, std::move(*error));
+            continue;
+        }
+
+        // Upstream would silently collapse these into one row, so reject the later copy here
+        if (batch.emails.count(dto.email) > 0) {
+            addError(report, config_.maxErrors, lineNumber, "Email already exists");
+            continue;
+        }
+
+        // Escaping can grow a field several times over, so measure the encoded row
+        std::size_t rowBytes = serializedSize(dto);
+        if (rowBytes > config_.batchBytes) {
+            addError(report, config_.maxErrors, lineNumber,
+                     "Row exceeds " + std::to_string(config_.batchBytes) + " bytes");
+            dto = CreateUserDto();
+            continue;
+        }
+        if (!batch.rows.empty()
+            && (batch.rows.size() >= config_.batchRows || batch.bytes + rowBytes > config_.batchBytes)) {
+            if (!flush()) {
+                return report;
+            }
+        }
+
+        batch.emails.insert(dto.email);
+        batch.bytes += rowBytes;
+        batch.lineNumbers.push_back(lineNumber);
+        batch.rows.push_back(std::move(dto));
+        dto = CreateUserDto();
+    }
+
+    flush();
+    return report;
+}
+
+} // namespace vicrow
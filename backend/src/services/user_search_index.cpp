@@ -0,0 +1,357 @@
+#include "services/user_search_index.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <mutex>
+
+namespace vicrow {
+
+namespace {
+
+char lower(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+std::string toLower(const std::string& text) {
+    std::string out(text);
+    for (auto& c : out) {
+        c = lower(c);
+    }
+    return out;
+}
+
+bool hasUpper(std::string_view text) {
+    return std::any_of(text.begin(), text.end(), [](char c) { return lower(c) != c; });
+}
+
+std::string trim(const std::string& text) {
+    auto begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    auto end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+std::uint32_t packTrigram(std::string_view text, std::size_t pos) {
+    return (static_cast<std::uint32_t>(static_cast<unsigned char>(text[pos])) << 16)
+         | (static_cast<std::uint32_t>(static_cast<unsigned char>(text[pos + 1])) << 8)
+         | static_cast<std::uint32_t>(static_cast<unsigned char>(text[pos + 2]));
+}
+
+void appendTrigrams(std::string_view text, std::vector<std::uint32_t>& out) {
+    for (std::size_t i = 0; i + 3 <= text.size(); ++i) {
+        out.push_back(packTrigram(text, i));
+    }
+}
+
+void sortUnique(std::vector<std::uint32_t>& grams) {
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+}
+
+bool startsWith(std::string_view text, std::string_view prefix) {
+    return text.substr(0, prefix.size()) == prefix;
+}
+
+/**
+ * @brief Prefix terms for a document: the whole email, the whole name and each later name word
+ */
+template<typename Fn>
+void forEachTerm(std::string_view email, std::string_view name, Fn&& fn) {
+    fn(email);
+    if (name.empty()) {
+        return;
+    }
+    fn(name);
+    std::size_t start = 0;
+    while (start < name.size()) {
+        auto end = name.find(' ', start);
+        if (end == std::string_view::npos) {
+            end = name.size();
+        }
+        if (end > start && start > 0) {
+            fn(name.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+}
+
+} // namespace
+
+void UserSearchIndex::attachEmailFilter(EmailFilter& filter) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    emails_ = &filter;
+}
+
+void UserSearchIndex::rebuild(const UserList& users) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    documents_.clear();
+    postings_.clear();
+    terms_.clear();
+    documents_.reserve(users.size());
+    for (const auto& user : users) {
+        insertLocked(user.toUser());
+    }
+
+    // The list may predate writes made while warming; keep whichever is newer
+    for (auto& write : pendingWrites_) {
+        if (!write.second.has_value()) {
+            removeLocked(write.first);
+            continue;
+        }
+        auto it = documents_.find(write.first);
+        if (it == documents_.end() || it->second.updatedAt <= write.second->updatedAt) {
+            removeLocked(write.first);
+            insertLocked(*write.second);
+        }
+    }
+    pendingWrites_.clear();
+    pendingWrites_.shrink_to_fit();
+
+    if (emails_ != nullptr) {
+        std::vector<std::string_view> emails;
+        emails.reserve(documents_.size());
+        for (const auto& entry : documents_) {
+            emails.push_back(entry.second.email());
+        }
+        emails_->rebuild(emails);
+    }
+    ready_ = true;
+}
+
+bool UserSearchIndex::isReady() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return ready_;
+}
+
+void UserSearchIndex::upsert(const User& user) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!ready_) {
+        pendingWrites_.emplace_back(user.id, user);
+    }
+
+    std::string previousEmail;
+    auto it = documents_.find(user.id);
+    if (it != documents_.end()) {
+        // A slower request may arrive after a newer write to the same user
+        if (it->second.updatedAt.has_value() && user.updatedAt.has_value()
+            && *user.updatedAt < *it->second.updatedAt) {
+            return;
+        }
+        previousEmail = std::string(it->second.email());
+    }
+    bool existed = it != documents_.end();
+    removeLocked(user.id);
+    insertLocked(user);
+
+    // Until the first rebuild the filter is not ready and is filled from the index instead
+    if (emails_ != nullptr && ready_ && (!existed || previousEmail != user.email)) {
+        if (existed) {
+            emails_->remove(previousEmail);
+        }
+        emails_->add(user.email);
+    }
+}
+
+void UserSearchIndex::remove(int id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!ready_) {
+        pendingWrites_.emplace_back(id, std::nullopt);
+    }
+    auto it = documents_.find(id);
+    if (it == documents_.end()) {
+        return;
+    }
+    if (emails_ != nullptr && ready_) {
+        emails_->remove(it->second.email());
+    }
+    removeLocked(id);
+}
+
+std::size_t UserSearchIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return documents_.size();
+}
+
+User UserSearchIndex::Document::toUser(int id) const {
+    User user;
+    user.id = id;
+    user.email = std::string(email());
+    if (hasName) {
+        user.name = std::string(name());
+    }
+    user.createdAt = createdAt;
+    user.updatedAt = updatedAt;
+    return user;
+}
+
+void UserSearchIndex::insertLocked(const User& user) {
+    Document doc;
+    doc.createdAt = user.createdAt;
+    doc.updatedAt = user.updatedAt;
+    doc.hasName = user.name.has_value();
+    const std::string& name = doc.hasName ? user.name.value() : std::string();
+    doc.emailLength = static_cast<std::uint32_t>(user.email.size());
+    doc.nameLength = static_cast<std::uint32_t>(name.size());
+
+    // Most emails are already lowercase, so the folded copy is usually skipped
+    doc.folded = hasUpper(user.email) || hasUpper(name);
+    doc.text.reserve((user.email.size() + name.size()) * (doc.folded ? 2 : 1));
+    doc.text += user.email;
+    doc.text += name;
+    if (doc.folded) {
+        doc.text += toLower(user.email);
+        doc.text += toLower(name);
+    }
+
+    std::vector<std::uint32_t> trigrams;
+    appendTrigrams(doc.lowerEmail(), trigrams);
+    appendTrigrams(doc.lowerName(), trigrams);
+    sortUnique(trigrams);
+    for (auto gram : trigrams) {
+        auto& ids = postings_[gram];
+        // Ids are mostly increasing (autoincrement), so appending is the fast path
+        if (ids.empty() || ids.back() < user.id) {
+            ids.push_back(user.id);
+        } else {
+            ids.insert(std::lower_bound(ids.begin(), ids.end(), user.id), user.id);
+        }
+    }
+    forEachTerm(doc.lowerEmail(), doc.lowerName(), [&](std::string_view term) {
+        terms_.emplace(std::string(term), user.id);
+    });
+
+    doc.text.shrink_to_fit();
+    documents_[user.id] = std::move(doc);
+}
+
+void UserSearchIndex::removeLocked(int id) {
+    auto it = documents_.find(id);
+    if (it == documents_.end()) {
+        return;
+    }
+    const Document& doc = it->second;
+
+    std::vector<std::uint32_t> trigrams;
+    appendTrigrams(doc.lowerEmail(), trigrams);
+    appendTrigrams(doc.lowerName(), trigrams);
+    sortUnique(trigrams);
+    for (auto gram : trigrams) {
+        auto posting = postings_.find(gram);
+        if (posting == postings_.end()) {
+            continue;
+        }
+        auto& ids = posting->second;
+        auto pos = std::lower_bound(ids.begin(), ids.end(), id);
+        if (pos != ids.end() && *pos == id) {
+            ids.erase(pos);
+        }
+        if (ids.empty()) {
+            postings_.erase(posting);
+        }
+    }
+    forEachTerm(doc.lowerEmail(), doc.lowerName(), [&](std::string_view term) {
+        terms_.erase({std::string(term), id});
+    });
+
+    documents_.erase(it);
+}
+
+int UserSearchIndex::score(const Document& doc, std::string_view query) {
+    std::string_view email = doc.lowerEmail();
+    std::string_view name = doc.lowerName();
+    if (email == query) return 100;
+    if (startsWith(email, query)) return 80;
+    if (name == query) return 70;
+    if (startsWith(name, query)) return 60;
+    for (std::size_t pos = name.find(' '); pos != std::string_view::npos; pos = name.find(' ', pos + 1)) {
+        if (startsWith(name.substr(pos + 1), query)) return 50;
+    }
+    if (email.find(query) != std::string_view::npos) return 20;
+    if (name.find(query) != std::string_view::npos) return 10;
+    return 0;
+}
+
+std::vector<User> UserSearchIndex::search(const std::string& query, std::size_t limit) const {
+    std::string needle = toLower(trim(query));
+    if (needle.empty() || limit == 0) {
+        return {};
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    std::vector<int> candidates;
+    if (needle.size() >= 3) {
+        std::vector<std::uint32_t> grams;
+        appendTrigrams(needle, grams);
+        sortUnique(grams);
+
+        std::vector<const std::vector<int>*> lists;
+        lists.reserve(grams.size());
+        for (auto gram : grams) {
+            auto posting = postings_.find(gram);
+            if (posting == postings_.end()) {
+                return {};
+            }
+            lists.push_back(&posting->second);
+        }
+
+        // Intersect smallest lists first to keep the working set small
+        std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) {
+            return a->size() < b->size();
+        });
+        candidates = *lists.front();
+        std::vector<int> next;
+        for (std::size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+            next.clear();
+            std::set_intersection(candidates.begin(), candidates.end(),
+                                  lists[i]->begin(), lists[i]->end(),
+                                  std::back_inserter(next));
+            candidates.swap(next);
+        }
+    } else {
+        for (auto it = terms_.lower_bound({needle, 0});
+             it != terms_.end() && startsWith(it->first, needle); ++it) {
+            candidates.push_back(it->second);
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+
+    // Verify and rank; trigram hits are not guaranteed to be substrings
+    struct Hit {
+        int score;
+        int id;
+        const Document* doc;
+    };
+    std::vector<Hit> hits;
+    hits.reserve(candidates.size());
+    for (int id : candidates) {
+        auto it = documents_.find(id);
+        if (it == documents_.end()) {
+            continue;
+        }
+        int s = score(it->second, needle);
+        if (s > 0) {
+            hits.push_back({s, id, &it->second});
+        }
+    }
+
+    auto better = [](const Hit& a, const Hit& b) {
+        if (a.score != b.score) return a.score > b.score;
+        if (a.doc->emailLength != b.doc->emailLength) return a.doc->emailLength < b.doc->emailLength;
+        return a.id < b.id;
+    };
+    std::size_t count = std::min(limit, hits.size());
+    std::partial_sort(hits.begin(), hits.begin() + static_cast<std::ptrdiff_t>(count), hits.end(), better);
+
+    std::vector<User> results;
+    results.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        results.push_back(hits[i].doc->toUser(hits[i].id));
+    }
+    return results;
+}
+
+} // namespace vicrow
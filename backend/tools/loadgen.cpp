@@ -0,0 +1,450 @@
+// HTTP load generator for vicrow_backend
+//
+// Opens many keep-alive connections and drives the user routes with a
+// configurable read/write mix for a fixed duration, then reports throughput
+// and latency percentiles to stdout and as JSON.
+//
+// By default each connection sends its next request as soon as the previous
+// one completes (closed loop), which measures peak throughput but hides
+// queueing: a stalled server also stalls the generator. With --rate the
+// connections share a fixed request schedule (open loop) and latency is
+// measured from each request's intended send time, so time spent waiting
+// behind a slow response is counted instead of omitted.
+//
+// Usage: vicrow_loadgen [--host 127.0.0.1] [--port 8080] [--connections 64]
+//                       [--duration 10] [--warmup 1] [--write-ratio 0.1]
+//                       [--list-ratio 0.05] [--users 1000] [--seed 42]
+//                       [--rate 0] [--output loadtest.json]
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct LoadConfig {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int connections = 64;
+    int durationSec = 10;
+    int warmupSec = 1;
+    double writeRatio = 0.1;
+    double listRatio = 0.05;
+    int users = 1000;
+    std::uint64_t seed = 42;
+    double rate = 0;   // total requests/s across all connections; 0 runs closed loop
+    std::string output = "loadtest.json";
+};
+
+enum class Op { Get, List, Create, Update, Delete, Count };
+
+const char* opName(Op op) {
+    switch (op) {
+        case Op::Get: return "get";
+        case Op::List: return "list";
+        case Op::Create: return "create";
+        case Op::Update: return "update";
+        case Op::Delete: return "delete";
+        default: return "unknown";
+    }
+}
+
+struct Sample {
+    std::uint32_t latencyUs;
+    std::uint16_t status;
+    Op op;
+};
+
+/**
+ * @brief Minimal blocking HTTP/1.1 client over one keep-alive connection
+ */
+class Connection {
+public:
+    Connection(const LoadConfig& config) : config_(config) {}
+    ~Connection() { disconnect(); }
+
+    /**
+     * @brief Send one request and read the full response
+     * @return HTTP status, or 0 on a transport error
+     */
+    int request(const std::string& method, const std::string& path, const std::string& body) {
+        // One retry covers a server that closed an idle keep-alive connection.
+        // A POST may already have been applied when the connection dropped, so
+        // only idempotent methods are sent twice.
+        int attempts = method == "POST" ? 1 : 2;
+        for (int attempt = 0; attempt < attempts; ++attempt) {
+            if (fd_ < 0 && !connect()) {
+                return 0;
+            }
+            int status = exchange(method, path, body);
+            if (status > 0) {
+                return status;
+            }
+            disconnect();
+        }
+        return 0;
+    }
+
+private:
+    bool connect() {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* result = nullptr;
+        if (getaddrinfo(config_.host.c_str(), std::to_string(config_.port).c_str(), &hints, &result) != 0) {
+            return false;
+        }
+        for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+            fd_ = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (fd_ < 0) continue;
+            if (::connect(fd_, ai->ai_addr, ai->ai_addrlen) == 0) break;
+            ::close(fd_);
+            fd_ = -1;
+        }
+        freeaddrinfo(result);
+        if (fd_ < 0) {
+            return false;
+        }
+        int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        buffer_.clear();
+        return true;
+    }
+
+    void disconnect() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    int exchange(const std::string& method, const std::string& path, const std::string& body) {
+        std::string request = method + " " + path + " HTTP/1.1\r\n"
+            "Host: " + config_.host + "\r\n"
+            "Connection: keep-alive\r\n";
+        if (!body.empty()) {
+            request += "Content-Type: application/json\r\n";
+        }
+        request += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+
+        std::size_t sent = 0;
+        while (sent < request.size()) {
+            ssize_t n = ::send(fd_, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return 0;
+            sent += static_cast<std::size_t>(n);
+        }
+
+        std::size_t headerEnd;
+        while ((headerEnd = buffer_.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) return 0;
+        }
+
+        // Status line: HTTP/1.1 200 OK
+        int status = 0;
+        auto space = buffer_.find(' ');
+        if (space != std::string::npos && space < headerEnd) {
+            status = std::atoi(buffer_.c_str() + space + 1);
+        }
+
+        std::size_t contentLength = 0;
+        bool keepAlive = true;
+        std::size_t lineStart = buffer_.find("\r\n") + 2;
+        while (lineStart < headerEnd) {
+            std::size_t lineEnd = buffer_.find("\r\n", lineStart);
+            std::string line = buffer_.substr(lineStart, lineEnd - lineStart);
+            std::string lower(line);
+            std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+            if (lower.rfind("content-length:", 0) == 0) {
+                contentLength = std::strtoull(line.c_str() + 15, nullptr, 10);
+            } else if (lower.rfind("connection:", 0) == 0 && lower.find("close") != std::string::npos) {
+                keepAlive = false;
+            }
+            lineStart = lineEnd + 2;
+        }
+
+        std::size_t total = headerEnd + 4 + contentLength;
+        while (buffer_.size() < total) {
+            if (!fill()) return 0;
+        }
+        buffer_.erase(0, total);
+
+        if (!keepAlive) {
+            disconnect();
+        }
+        return status;
+    }
+
+    bool fill() {
+        char chunk[16384];
+        ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer_.append(chunk, static_cast<std::size_t>(n));
+        return true;
+    }
+
+    const LoadConfig& config_;
+    int fd_ = -1;
+    std::string buffer_;
+};
+
+/**
+ * @brief One load-generating connection with its own deterministic RNG
+ */
+void runWorker(const LoadConfig& config, int index, Clock::time_point measureStart,
+               Clock::time_point end, std::vector<Sample>& samples, std::uint64_t& missed) {
+    Connection conn(config);
+    std::mt19937_64 rng(config.seed + static_cast<std::uint64_t>(index));
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_int_distribution<int> userId(1, std::max(config.users, 1));
+    std::uint64_t created = 0;
+
+    // Open loop: this connection's share of the schedule, staggered so the
+    // connections do not all fire at once
+    bool openLoop = config.rate > 0;
+    Clock::duration interval{};
+    Clock::time_point nextSend = Clock::now();
+    if (openLoop) {
+        interval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(config.connections / config.rate));
+        nextSend += interval * index / config.connections;
+    }
+
+    while (Clock::now() < end && (!openLoop || nextSend < end)) {
+        Op op;
+        double roll = unit(rng);
+        if (roll < config.writeRatio) {
+            // Writes split 2:2:1 between create, update and delete
+            double kind = unit(rng);
+            op = kind < 0.4 ? Op::Create : (kind < 0.8 ? Op::Update : Op::Delete);
+        } else {
+            op = unit(rng) < config.listRatio ? Op::List : Op::Get;
+        }
+
+        std::string method = "GET";
+        std::string path;
+        std::string body;
+        switch (op) {
+            case Op::Get:
+                path = "/api/users/" + std::to_string(userId(rng));
+                break;
+            case Op::List:
+                path = "/api/users";
+                break;
+            case Op::Create:
+                method = "POST";
+                path = "/api/users";
+                body = json{{"email", "load-" + std::to_string(config.seed) + "-" + std::to_string(index)
+                                          + "-" + std::to_string(created++) + "@example.com"},
+                            {"name", "Load Test"}}.dump();
+                break;
+            case Op::Update:
+                method = "PUT";
+                path = "/api/users/" + std::to_string(userId(rng));
+                body = json{{"name", "Updated " + std::to_string(rng() % 1000)}}.dump();
+                break;
+            case Op::Delete:
+                method = "DELETE";
+                path = "/api/users/" + std::to_string(userId(rng));
+                break;
+            default:
+                break;
+        }
+
+        Clock::time_point started;
+        if (openLoop) {
+            // A late request is sent immediately and charged from its slot,
+            // not from when the connection became free
+            std::this_thread::sleep_until(nextSend);
+            started = nextSend;
+            nextSend += interval;
+        } else {
+            started = Clock::now();
+        }
+        int status = conn.request(method, path, body);
+        auto finished = Clock::now();
+
+        if (started >= measureStart) {
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(finished - started).count();
+            samples.push_back({static_cast<std::uint32_t>(std::min<long long>(us, UINT32_MAX)),
+                               static_cast<std::uint16_t>(status), op});
+        }
+    }
+
+    // Slots the server was too slow to reach; a non-zero count means the
+    // target rate was above what it could sustain
+    if (openLoop && nextSend < end) {
+        missed = static_cast<std::uint64_t>((end - nextSend + interval - Clock::duration(1)) / interval);
+    }
+}
+
+double percentile(const std::vector<std::uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    auto rank = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+json latencyReport(std::vector<std::uint32_t>& latencies, double seconds) {
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0;
+    for (auto v : latencies) sum += v;
+
+    json report;
+    report["requests"] = latencies.size();
+    report["rps"] = seconds > 0 ? static_cast<double>(latencies.size()) / seconds : 0.0;
+    report["latency_us"] = {
+        {"mean", latencies.empty() ? 0.0 : sum / static_cast<double>(latencies.size())},
+        {"p50", percentile(latencies, 0.50)},
+        {"p90", percentile(latencies, 0.90)},
+        {"p99", percentile(latencies, 0.99)},
+        {"p99.9", percentile(latencies, 0.999)},
+        {"max", latencies.empty() ? 0u : latencies.back()},
+    };
+    return report;
+}
+
+LoadConfig parseArgs(int argc, char** argv) {
+    LoadConfig config;
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for option: " << flag << std::endl;
+            std::exit(1);
+        }
+        const char* value = argv[i + 1];
+        if (flag == "--host") config.host = value;
+        else if (flag == "--port") config.port = std::atoi(value);
+        else if (flag == "--connections") config.connections = std::max(1, std::atoi(value));
+        else if (flag == "--duration") config.durationSec = std::max(1, std::atoi(value));
+        else if (flag == "--warmup") config.warmupSec = std::max(0, std::atoi(value));
+        else if (flag == "--write-ratio") config.writeRatio = std::atof(value);
+        else if (flag == "--list-ratio") config.listRatio = std::atof(value);
+        else if (flag == "--users") config.users = std::atoi(value);
+        else if (flag == "--seed") config.seed = std::strtoull(value, nullptr, 10);
+        else if (flag == "--rate") config.rate = std::max(0.0, std::atof(value));
+        else if (flag == "--output") config.output = value;
+        else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            std::exit(1);
+        }
+    }
+    return config;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    LoadConfig config = parseArgs(argc, argv);
+
+    std::cout << "Load testing http://" << config.host << ":" << config.port
+              << " with " << config.connections << " connections for "
+              << config.durationSec << "s (+" << config.warmupSec << "s warmup), write ratio "
+              << config.writeRatio;
+    if (config.rate > 0) {
+        std::cout << ", open loop at " << config.rate << " req/s";
+    }
+    std::cout << std::endl;
+
+    auto start = Clock::now();
+    auto measureStart = start + std::chrono::seconds(config.warmupSec);
+    auto end = measureStart + std::chrono::seconds(config.durationSec);
+
+    std::vector<std::vector<Sample>> samples(static_cast<std::size_t>(config.connections));
+    std::vector<std::uint64_t> missed(samples.size(), 0);
+    std::vector<std::thread> workers;
+    workers.reserve(samples.size());
+    for (int i = 0; i < config.connections; ++i) {
+        workers.emplace_back(runWorker, std::cref(config), i, measureStart, end,
+                             std::ref(samples[static_cast<std::size_t>(i)]),
+                             std::ref(missed[static_cast<std::size_t>(i)]));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - measureStart).count();
+
+    std::vector<std::uint32_t> all;
+    std::vector<std::vector<std::uint32_t>> byOp(static_cast<std::size_t>(Op::Count));
+    std::map<std::string, std::uint64_t> statuses;
+    std::uint64_t errors = 0;
+    for (const auto& perWorker : samples) {
+        for (const auto& sample : perWorker) {
+            all.push_back(sample.latencyUs);
+            byOp[static_cast<std::size_t>(sample.op)].push_back(sample.latencyUs);
+            statuses[sample.status ? std::to_string(sample.status) : "transport_error"]++;
+            // 404s are expected for deletes/updates of already-deleted ids
+            if (sample.status == 0 || sample.status >= 500) {
+                ++errors;
+            }
+        }
+    }
+
+    json report = latencyReport(all, seconds);
+    report["errors"] = errors;
+    if (config.rate > 0) {
+        std::uint64_t totalMissed = 0;
+        for (auto m : missed) totalMissed += m;
+        report["missed"] = totalMissed;
+    }
+    report["duration_s"] = seconds;
+    report["status"] = statuses;
+    report["config"] = {
+        {"host", config.host},
+        {"port", config.port},
+        {"connections", config.connections},
+        {"duration_s", config.durationSec},
+        {"warmup_s", config.warmupSec},
+        {"write_ratio", config.writeRatio},
+        {"list_ratio", config.listRatio},
+        {"users", config.users},
+        {"seed", config.seed},
+        {"rate", config.rate},
+    };
+    json operations = json::object();
+    for (std::size_t i = 0; i < byOp.size(); ++i) {
+        if (!byOp[i].empty()) {
+            operations[opName(static_cast<Op>(i))] = latencyReport(byOp[i], seconds);
+        }
+    }
+    report["operations"] = operations;
+
+    const json& latency = report["latency_us"];
+    std::cout << "\nRequests:   " << report["requests"] << " (" << errors << " errors";
+    if (report.contains("missed")) {
+        std::cout << ", " << report["missed"] << " missed";
+    }
+    std::cout << ")\n"
+              << "Throughput: " << report["rps"].get<double>() << " req/s\n"
+              << "Latency us: p50 " << latency["p50"] << ", p90 " << latency["p90"]
+              << ", p99 " << latency["p99"] << ", p99.9 " << latency["p99.9"]
+              << ", max " << latency["max"] << std::endl;
+
+    std::ofstream out(config.output);
+    if (!out) {
+        std::cerr << "Could not write report to " << config.output << std::endl;
+        return 1;
+    }
+    out << report.dump(2) << std::endl;
+    std::cout << "Report written to " << config.output << std::endl;
+
+    return 0;
+}
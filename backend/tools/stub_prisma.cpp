@@ -0,0 +1,339 @@
+// Deterministic stand-in for the Node.js Prisma service (prisma/server.ts)
+//
+// Serves the user endpoints the backend calls from an in-memory store, with
+// configurable latency and error injection, so vicrow_backend can be load
+// tested without Node or PostgreSQL.
+//
+// Usage: vicrow_stub_prisma [--port 3001] [--users 1000] [--latency-ms 0]
+//                           [--jitter-ms 0] [--error-rate 0] [--seed 42]
+//                           [--threads 32]
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <crow.h>
+#include "models/url_encoding.hpp"
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+struct StubConfig {
+    int port = 3001;
+    int users = 1000;
+    int latencyMs = 0;
+    int jitterMs = 0;
+    double errorRate = 0.0;
+    std::uint64_t seed = 42;
+    int threads = 32;
+};
+
+// Fixed timestamp so responses are byte-for-byte reproducible
+const char* STUB_TIMESTAMP = "2026-01-01T00:00:00.000Z";
+
+std::uint64_t splitmix64(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief In-memory user table with injected latency and failures
+ *
+ * Latency and failures are drawn from a hash of (seed, request number), so
+ * the same request sequence always sees the same delays and errors.
+ */
+class StubStore {
+public:
+    explicit StubStore(const StubConfig& config) : config_(config) {
+        for (int id = 1; id <= config_.users; ++id) {
+            std::string email = "user" + std::to_string(id) + "@example.com";
+            users_[id] = makeUser(id, email, "User " + std::to_string(id));
+            emails_[email] = id;
+        }
+        nextId_ = config_.users + 1;
+    }
+
+    /**
+     * @brief Sleep for the configured latency; returns false to inject a failure
+     */
+    bool admit() {
+        std::uint64_t roll = splitmix64(config_.seed ^ requests_.fetch_add(1, std::memory_order_relaxed));
+        int delay = config_.latencyMs;
+        if (config_.jitterMs > 0) {
+            delay += static_cast<int>(roll % static_cast<std::uint64_t>(config_.jitterMs + 1));
+        }
+        if (delay > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        }
+        double unit = static_cast<double>(roll >> 11) / static_cast<double>(1ull << 53);
+        return unit >= config_.errorRate;
+    }
+
+    json list() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        json result = json::array();
+        // Newest first, like the real service's orderBy createdAt desc
+        for (auto it = users_.rbegin(); it != users_.rend(); ++it) {
+            result.push_back(it->second);
+        }
+        return result;
+    }
+
+    json find(int id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = users_.find(id);
+        return it == users_.end() ? json(nullptr) : it->second;
+    }
+
+    json findByEmail(const std::string& email) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = emails_.find(email);
+        return it == emails_.end() ? json(nullptr) : users_[it->second];
+    }
+
+    json create(const std::string& email, const json& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return insertLocked(email, name);
+    }
+
+    /**
+     * @brief Create each row, returning {"user"} or {"error"} per row like /api/users/batch
+     */
+    json createMany(const json& rows) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        json results = json::array();
+        for (const auto& row : rows) {
+            std::string email = row.value("email", "");
+            json name = row.contains("name") ? row["name"] : json(nullptr);
+            json user = email.empty() ? json(nullptr) : insertLocked(email, name);
+            if (user.is_null()) {
+                results.push_back({{"error", email.empty() ? "Email is required" : "Email already exists"}});
+            } else {
+                results.push_back({{"user", user}});
+            }
+        }
+        return results;
+    }
+
+    /**
+     * @brief All users as NDJSON in id order, like /api/users/export
+     */
+    std::string exportNdjson() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string out;
+        for (const auto& entry : users_) {
+            out += entry.second.dump();
+            out += '\n';
+        }
+        return out;
+    }
+
+    /**
+     * @brief Apply a partial update; null if the id is unknown
+     *
+     * Like the unique constraint on User.email, an email owned by another
+     * user is rejected (emailTaken set) and nothing is changed.
+     */
+    json update(int id, const json& body, bool& emailTaken) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        emailTaken = false;
+        auto it = users_.find(id);
+        if (it == users_.end()) {
+            return nullptr;
+        }
+        if (body.contains("email") && body["email"].is_string()) {
+            const auto& email = body["email"].get_ref<const std::string&>();
+            auto owner = emails_.find(email);
+            if (owner != emails_.end() && owner->second != id) {
+                emailTaken = true;
+                return nullptr;
+            }
+            emails_.erase(it->second["email"].get<std::string>());
+            it->second["email"] = email;
+            emails_[email] = id;
+        }
+        if (body.contains("name")) {
+            it->second["name"] = body["name"];
+        }
+        return it->second;
+    }
+
+    bool remove(int id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = users_.find(id);
+        if (it == users_.end()) {
+            return false;
+        }
+        emails_.erase(it->second["email"].get<std::string>());
+        users_.erase(it);
+        return true;
+    }
+
+private:
+    json insertLocked(const std::string& email, const json& name) {
+        if (emails_.count(email) > 0) {
+            return nullptr;
+        }
+        int id = nextId_++;
+        users_[id] = makeUser(id, email, name);
+        emails_[email] = id;
+        return users_[id];
+    }
+
+    static json makeUser(int id, const std::string& email, const json& name) {
+        json user;
+        user["id"] = id;
+        user["email"] = email;
+        user["name"] = name;
+        user["createdAt"] = STUB_TIMESTAMP;
+        user["updatedAt"] = STUB_TIMESTAMP;
+        return user;
+    }
+
+    StubConfig config_;
+    std::mutex mutex_;
+    std::map<int, json> users_;
+    std::unordered_map<std::string, int> emails_;
+    int nextId_ = 1;
+    std::atomic<std::uint64_t> requests_{0};
+};
+
+crow::response jsonResponse(int code, const json& body) {
+    crow::response res(code, body.dump());
+    res.add_header("Content-Type", "application/json");
+    return res;
+}
+
+crow::response injectedFailure() {
+    return jsonResponse(500, {{"error", "Injected failure"}});
+}
+
+StubConfig parseArgs(int argc, char** argv) {
+    StubConfig config;
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for option: " << flag << std::endl;
+            std::exit(1);
+        }
+        const char* value = argv[i + 1];
+        if (flag == "--port") config.port = std::atoi(value);
+        else if (flag == "--users") config.users = std::atoi(value);
+        else if (flag == "--latency-ms") config.latencyMs = std::atoi(value);
+        else if (flag == "--jitter-ms") config.jitterMs = std::atoi(value);
+        else if (flag == "--error-rate") config.errorRate = std::atof(value);
+        else if (flag == "--seed") config.seed = std::strtoull(value, nullptr, 10);
+        else if (flag == "--threads") config.threads = std::atoi(value);
+        else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            std::exit(1);
+        }
+    }
+    return config;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    StubConfig config = parseArgs(argc, argv);
+    StubStore store(config);
+
+    crow::SimpleApp app;
+    app.loglevel(crow::LogLevel::Warning);
+
+    CROW_ROUTE(app, "/health")
+    ([]() {
+        return jsonResponse(200, {{"status", "ok"}, {"message", "Stub Prisma service"}, {"database", "stub"}});
+    });
+
+    CROW_ROUTE(app, "/api/users")
+    ([&store]() {
+        if (!store.admit()) return injectedFailure();
+        return jsonResponse(200, store.list());
+    });
+
+    CROW_ROUTE(app, "/api/users/<int>")
+    ([&store](int id) {
+        if (!store.admit()) return injectedFailure();
+        json user = store.find(id);
+        if (user.is_null()) return jsonResponse(404, {{"error", "User not found"}});
+        return jsonResponse(200, user);
+    });
+
+    CROW_ROUTE(app, "/api/users/email/<string>")
+    ([&store](const std::string& email) {
+        if (!store.admit()) return injectedFailure();
+        json user = store.findByEmail(vicrow::decodePathSegment(email));
+        if (user.is_null()) return jsonResponse(404, {{"error", "User not found"}});
+        return jsonResponse(200, user);
+    });
+
+    CROW_ROUTE(app, "/api/users").methods(crow::HTTPMethod::POST)
+    ([&store](const crow::request& req) {
+        if (!store.admit()) return injectedFailure();
+        json body = json::parse(req.body, nullptr, false);
+        if (body.is_discarded() || !body.contains("email") || !body["email"].is_string()) {
+            return jsonResponse(400, {{"error", "Email is required"}});
+        }
+        json user = store.create(body["email"].get<std::string>(), body.value("name", json(nullptr)));
+        if (user.is_null()) return jsonResponse(400, {{"error", "Email already exists"}});
+        return jsonResponse(201, user);
+    });
+
+    CROW_ROUTE(app, "/api/users/batch").methods(crow::HTTPMethod::POST)
+    ([&store](const crow::request& req) {
+        if (!store.admit()) return injectedFailure();
+        json body = json::parse(req.body, nullptr, false);
+        if (body.is_discarded() || !body.contains("users") || !body["users"].is_array()) {
+            return jsonResponse(400, {{"error", "users must be an array"}});
+        }
+        return jsonResponse(200, {{"results", store.createMany(body["users"])}});
+    });
+
+    CROW_ROUTE(app, "/api/users/export")
+    ([&store]() {
+        if (!store.admit()) return injectedFailure();
+        crow::response res(200, store.exportNdjson());
+        res.add_header("Content-Type", "application/x-ndjson");
+        return res;
+    });
+
+    CROW_ROUTE(app, "/api/users/<int>").methods(crow::HTTPMethod::PUT)
+    ([&store](const crow::request& req, int id) {
+        if (!store.admit()) return injectedFailure();
+        json body = json::parse(req.body, nullptr, false);
+        if (body.is_discarded()) body = json::object();
+        bool emailTaken = false;
+        json user = store.update(id, body, emailTaken);
+        if (emailTaken) return jsonResponse(400, {{"error", "Email already exists"}});
+        if (user.is_null()) return jsonResponse(404, {{"error", "User not found"}});
+        return jsonResponse(200, user);
+    });
+
+    CROW_ROUTE(app, "/api/users/<int>").methods(crow::HTTPMethod::DELETE)
+    ([&store](int id) {
+        if (!store.admit()) return injectedFailure();
+        if (!store.remove(id)) return jsonResponse(404, {{"error", "User not found"}});
+        return jsonResponse(200, {{"message", "User deleted successfully"}});
+    });
+
+    std::cout << "Stub Prisma service on http://localhost:" << config.port
+              << " (" << config.users << " users, latency " << config.latencyMs
+              << "+" << config.jitterMs << "ms, error rate " << config.errorRate << ")" << std::endl;
+
+    app.port(static_cast<std::uint16_t>(config.port))
+       .concurrency(static_cast<std::uint16_t>(config.threads))
+       .run();
+
+    return 0;
+}
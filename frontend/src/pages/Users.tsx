@@ -148,7 +148,7 @@ export default function Users() {
                 <h3 className="font-semibold">{user.name || 'Unnamed User'}</h3>
                 <p className="text-secondary-400 text-sm">{user.email}</p>
                 <p className="text-secondary-500 text-xs mt-1">
-                  Created: {new Date(user.createdAt).toLocaleDateString()}
+                  Created: {user.createdAt ? new Date(user.createdAt).toLocaleDateString() : 'Unknown'}
                 </p>
               </div>
               <div className="flex space-x-2">
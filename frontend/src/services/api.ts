@@ -6,8 +6,8 @@ export interface User {
   id: number
   email: string
   name: string | null
-  createdAt: string
-  updatedAt: string
+  createdAt: string | null
+  updatedAt: string | null
 }
 
 export interface CreateUserDto {
@@ -11,6 +11,8 @@ export default defineConfig({
         target: 'http://localhost:8080',
         changeOrigin: true,
         secure: false,
+        ws: true,
+        xfwd: true,
       }
     }
   },
@@ -54,6 +54,92 @@ app.get('/api/users', async (req: Request, res: Response) => {
   }
 });
 
+// GET /api/users/export - Stream all users as NDJSON
+// Keyset pagination on id keeps memory flat; writes wait for 'drain' so a
+// slow reader pauses the cursor instead of buffering the table. A client
+// that disconnects never drains, so 'close' also ends the wait and the cursor.
+const EXPORT_PAGE_SIZE = 1000;
+
+app.get('/api/users/export', async (req: Request, res: Response) => {
+  res.setHeader('Content-Type', 'application/x-ndjson');
+  let clientClosed = false;
+  const closed = new Promise<void>((resolve) => res.once('close', () => {
+    clientClosed = true;
+    resolve();
+  }));
+  try {
+    let cursor: number | undefined;
+    while (!clientClosed) {
+      const page = await prisma.user.findMany({
+        take: EXPORT_PAGE_SIZE,
+        ...(cursor !== undefined && { skip: 1, cursor: { id: cursor } }),
+        orderBy: { id: 'asc' }
+      });
+      if (page.length === 0) {
+        break;
+      }
+
+      const chunk = page.map((user) => JSON.stringify(user)).join('\n') + '\n';
+      if (!res.write(chunk)) {
+        await Promise.race([new Promise<void>((resolve) => res.once('drain', resolve)), closed]);
+      }
+
+      cursor = page[page.length - 1].id;
+      if (page.length < EXPORT_PAGE_SIZE) {
+        break;
+      }
+    }
+    if (!clientClosed) {
+      res.end();
+    }
+  } catch (error) {
+    console.error('Error exporting users:', error);
+    // Headers are already sent; cut the stream so the client sees a failed transfer
+    res.destroy(error as Error);
+  }
+});
+
+// POST /api/users/batch - Create many users, reporting each row
+app.post('/api/users/batch', async (req: Request, res: Response) => {
+  try {
+    const rows = req.body.users;
+    if (!Array.isArray(rows)) {
+      return res.status(400).json({ error: 'users must be an array' });
+    }
+    const users: { email: string; name: string | null }[] = rows.map((row: any) => ({
+      email: String(row?.email ?? ''),
+      name: typeof row?.name === 'string' ? row.name : null
+    }));
+    // createManyAndReturn reports exactly the rows this call inserted, so a
+    // concurrent insert of the same email is never mistaken for ours
+    const seen = new Set<string>();
+    const fresh = users.filter((user) => {
+      if (!user.email || seen.has(user.email)) {
+        return false;
+      }
+      seen.add(user.email);
+      return true;
+    });
+    const created = await prisma.user.createManyAndReturn({ data: fresh, skipDuplicates: true });
+    const byEmail = new Map(created.map((user) => [user.email, user]));
+
+    const results = users.map((user) => {
+      if (!user.email) {
+        return { error: 'Email is required' };
+      }
+      // Each created row is claimed once; later copies in the batch are duplicates
+      const row = byEmail.get(user.email);
+      byEmail.delete(user.email);
+      return row ? { user: row } : { error: 'Email already exists' };
+    });
+
+    res.json({ results });
+  } catch (error) {
+    console.error('Error creating users:', error);
+    res.status(500).json({ error: 'Failed to create users' });
+  }
+});
+
 // GET /api/users/:id - Get user by ID
 app.get('/api/users/:id', async (req: Request, res: Response) => {
   try {
@@ -166,6 +252,43 @@ app.delete('/api/users/:id', async (req: Request, res: Response) => {
 
 // ==================== POST ROUTES ====================
 
+// Columns the backend may select on posts and on each included relation
+const POST_FIELDS = ['id', 'title', 'content', 'published', 'createdAt', 'updatedAt', 'authorId'];
+const POST_RELATION_FIELDS: Record<string, string[]> = {
+  author: ['id', 'email', 'name', 'createdAt', 'updatedAt'],
+  tags: ['id', 'name'],
+  comments: ['id', 'content', 'createdAt', 'postId'],
+};
+
+// Build a Prisma select for posts from the backend's request, keeping only
+// known columns so callers cannot reach relations beyond one level
+function buildPostSelect(requested: any) {
+  const select: Record<string, any> = {};
+  const source = requested && typeof requested === 'object' ? requested : {};
+
+  for (const field of POST_FIELDS) {
+    if (source[field] === true) select[field] = true;
+  }
+
+  for (const [relation, fields] of Object.entries(POST_RELATION_FIELDS)) {
+    const nested = source[relation]?.select;
+    if (!nested || typeof nested !== 'object') continue;
+
+    const relationSelect: Record<string, boolean> = {};
+    for (const field of fields) {
+      if (nested[field] === true) relationSelect[field] = true;
+    }
+    if (Object.keys(relationSelect).length > 0) {
+      select[relation] = { select: relationSelect };
+    }
+  }
+
+  if (Object.keys(select).length === 0) {
+    for (const field of POST_FIELDS) select[field] = true;
+  }
+  return select;
+}
+
 // GET /api/posts - Get all posts
 app.get('/api/posts', async (req: Request, res: Response) => {
   try {
@@ -180,6 +303,20 @@ app.get('/api/posts', async (req: Request, res: Response) => {
   }
 });
 
+// POST /api/posts/query - Get all posts with a column/relation select
+app.post('/api/posts/query', async (req: Request, res: Response) => {
+  try {
+    const posts = await prisma.post.findMany({
+      select: buildPostSelect(req.body.select),
+      orderBy: { createdAt: 'desc' }
+    });
+    res.json(posts);
+  } catch (error) {
+    console.error('Error querying posts:', error);
+    res.status(500).json({ error: 'Failed to fetch posts' });
+  }
+});
+
 // GET /api/posts/:id - Get post by ID
 app.get('/api/posts/:id', async (req: Request, res: Response) => {
   try {
@@ -200,24 +337,118 @@ app.get('/api/posts/:id', async (req: Request, res: Response) => {
   }
 });
 
+// POST /api/posts/:id/query - Get post by ID with a column/relation select
+app.post('/api/posts/:id/query', async (req: Request, res: Response) => {
+  try {
+    const id = parseInt(req.params.id);
+    const post = await prisma.post.findUnique({
+      where: { id },
+      select: buildPostSelect(req.body.select)
+    });
+
+    if (!post) {
+      return res.status(404).json({ error: 'Post not found' });
+    }
+
+    res.json(post);
+  } catch (error) {
+    console.error('Error querying post:', error);
+    res.status(500).json({ error: 'Failed to fetch post' });
+  }
+});
+
 // POST /api/posts - Create post
 app.post('/api/posts', async (req: Request, res: Response) => {
   try {
-    const { title, content, published, authorId } = req.body;
+    const { title, content, published, authorId, tags } = req.body;
     
     if (!title || !authorId) {
       return res.status(400).json({ error: 'Title and authorId are required' });
     }
     
     const post = await prisma.post.create({
-      data: { title, content, published, authorId },
-      include: { author: true }
+      data: {
+        title,
+        content,
+        published,
+        authorId,
+        ...(Array.isArray(tags) && {
+          tags: {
+            connectOrCreate: tags.map((name: string) => ({
+              where: { name },
+              create: { name }
+            }))
+          }
+        })
+      },
+      include: { author: true, tags: true }
     });
     
     res.status(201).json(post);
-  } catch (error) {
+  } catch (error: any) {
     console.error('Error creating post:', error);
-    res.status(500).json({ error: 'Failed to create post' });
+    if (error.code === 'P2003') {
+      res.status(400).json({ error: 'Author not found' });
+    } else {
+      res.status(500).json({ error: 'Failed to create post' });
+    }
+  }
+});
+
+// ==================== COMMENT ROUTES ====================
+
+// GET /api/posts/:id/comments - Get comments on a post
+app.get('/api/posts/:id/comments', async (req: Request, res: Response) => {
+  try {
+    const postId = parseInt(req.params.id);
+    const comments = await prisma.comment.findMany({
+      where: { postId },
+      orderBy: { createdAt: 'asc' }
+    });
+    res.json(comments);
+  } catch (error) {
+    console.error('Error fetching comments:', error);
+    res.status(500).json({ error: 'Failed to fetch comments' });
+  }
+});
+
+// POST /api/posts/:id/comments - Add a comment to a post
+app.post('/api/posts/:id/comments', async (req: Request, res: Response) => {
+  try {
+    const postId = parseInt(req.params.id);
+    const { content } = req.body;
+
+    if (!content) {
+      return res.status(400).json({ error: 'Content is required' });
+    }
+
+    const comment = await prisma.comment.create({
+      data: { content, postId }
+    });
+
+    res.status(201).json(comment);
+  } catch (error: any) {
+    console.error('Error creating comment:', error);
+    if (error.code === 'P2003') {
+      res.status(404).json({ error: 'Post not found' });
+    } else {
+      res.status(500).json({ error: 'Failed to create comment' });
+    }
+  }
+});
+
+// ==================== TAG ROUTES ====================
+
+// GET /api/tags - Get all tags
+app.get('/api/tags', async (req: Request, res: Response) => {
+  try {
+    const tags = await prisma.tag.findMany({
+      orderBy: { name: 'asc' }
+    });
+    res.json(tags);
+  } catch (error) {
+    console.error('Error fetching tags:', error);
+    res.status(500).json({ error: 'Failed to fetch tags' });
   }
 });
 